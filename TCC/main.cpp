@@ -23,6 +23,8 @@
 
 #include <openssl/x509v3.h>
 
+#include <openssl/rand.h>
+
 #include <inttypes.h>
 
 #include <string.h>
@@ -35,12 +37,46 @@
 #include <stdexcept>
 #include <execinfo.h>
 #include <unistd.h>
+#include <mutex>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdarg.h>
+#include <algorithm>
 
 
 #define NULL nullptr
 
 #define DFT "Indeterminado"
 
+// Intervalo de bytes sem posse dos dados: não libera nada ao sair de escopo. Aponta para o conteúdo
+// de um ByteArray, de um MappedFile ou de qualquer buffer que viva mais que a própria view.
+struct ByteView
+{
+    const unsigned char *data{nullptr};
+    size_t len{0};
+};
+
+// Arquivo mapeado somente para leitura; dono do mapeamento, liberado com unmapFile
+struct MappedFile
+{
+    void *address{nullptr};
+    size_t len{0};
+};
+
+// Codificação detectada de um objeto (certificado, CRL ou assinatura)
+enum EncodingFormat
+{
+    ENCODING_UNKNOWN = 0,
+    ENCODING_DER = 1, // Começa por um SEQUENCE ASN.1 que cabe no buffer
+    ENCODING_PEM = 2  // Contém a armadura "-----BEGIN "
+};
+
 // Definindo a estrutura de um ByteArray
 typedef struct ByteArray
 {
@@ -131,6 +167,171 @@ struct CertificateInformation
     bool signatureIsValid = false;       // Indica se a assinatura do certificado é válida
 };
 
+// Arena de strings: blocos grandes alocados sob demanda e liberados de uma vez (freeStringArena) ou
+// reaproveitados (resetStringArena), em vez de uma alocação por campo extraído.
+struct StringArena
+{
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t blockUsed = 0;     // Bytes usados no último bloco
+    size_t blockCapacity = 0; // Tamanho do último bloco
+};
+
+// Campos de um certificado extraídos em uma única passada (ver extractCertificateFields). As strings
+// pertencem à arena usada na extração e são nulas quando o atributo não existe no certificado.
+struct CertificateFields
+{
+    const char *subjectCN = nullptr;
+    const char *issuerCN = nullptr;
+    const char *subjectCountry = nullptr;
+    const char *subjectOrganization = nullptr;
+    const char *subjectOrganizationUnit = nullptr;
+    const char *serialNumber = nullptr; // Hexadecimal, como BN_bn2hex
+    int64_t notBefore = 0;              // Início da validade, em segundos desde a época (UTC)
+    int64_t notAfter = 0;               // Fim da validade, em segundos desde a época (UTC)
+    bool expired = false;               // Fora do período de validade no momento da extração
+};
+
+// Níveis de log das funções da biblioteca; mensagens acima do nível atual não são formatadas
+enum LogLevel
+{
+    LOG_NONE = 0,
+    LOG_ERROR = 1,
+    LOG_INFO = 2,
+    LOG_DEBUG = 3
+};
+
+// Conjunto de certificados candidatos para a montagem de caminhos de certificação, indexado pelo
+// identificador de chave do titular (SKI) e pelo hash do nome do titular (ver buildCertificationPath).
+struct CertificatePool
+{
+    std::vector<X509 *> certificates;                              // Referências mantidas pelo pool
+    std::unordered_multimap<std::string, size_t> bySubjectKeyId;   // SKI -> posição em certificates
+    std::unordered_multimap<unsigned long, size_t> bySubjectName;  // Hash do nome do titular -> posição
+    std::unordered_map<std::string, size_t> byFingerprint;         // SHA-256 do certificado, para descartar repetidos
+};
+
+// Base de revogação compilada (ver compileRevocationDb): um arquivo mapeado com o cabeçalho, a tabela
+// de emissores ordenada pelo hash da chave e, para cada emissor, os seriais revogados ordenados.
+// Os inteiros ficam na ordem de bytes da máquina que compilou a base.
+struct RevocationDbHeader
+{
+    char magic[8];           // "TCCRVDB\0"
+    uint32_t version;        // revocationDbVersion
+    uint32_t issuerCount;    // Entradas na tabela de emissores
+    int64_t compiledAt;      // Segundos desde a época (UTC)
+    uint64_t issuersOffset;  // Início da tabela de emissores
+    uint64_t fileSize;       // Tamanho total, conferido ao abrir
+};
+
+struct RevocationDbIssuer
+{
+    unsigned char issuerKeyHash[20]; // SHA-1 da chave pública do emissor, como o issuerKeyHash do OCSP
+    uint32_t serialCount;
+    int64_t thisUpdate;              // Da CRL compilada, em segundos desde a época
+    int64_t nextUpdate;              // 0 se a CRL não informar
+    uint64_t serialsOffset;          // Início do array de RevocationDbSerial deste emissor
+};
+
+struct RevocationDbSerial
+{
+    unsigned char serial[20]; // Octetos do serial, completados com zeros
+    uint8_t serialLength;     // Octetos usados; o bit 0x80 marca serial negativo
+    int8_t reason;            // Motivo da revogação (CRL_REASON_*), -1 se ausente
+    uint8_t padding[2];
+    int64_t revocationDate;   // Segundos desde a época (UTC)
+};
+
+static_assert(sizeof(RevocationDbHeader) == 40 && sizeof(RevocationDbIssuer) == 48 && sizeof(RevocationDbSerial) == 32,
+              "layout do arquivo da base de revogação");
+
+// Base de revogação aberta com openRevocationDb
+struct RevocationDb
+{
+    MappedFile *file = nullptr;
+    const RevocationDbHeader *header = nullptr;
+    const RevocationDbIssuer *issuers = nullptr;
+};
+
+// Resultado de uma consulta à base de revogação
+enum RevocationDbStatus
+{
+    REVOCATION_DB_NOT_REVOKED = 0,
+    REVOCATION_DB_REVOKED = 1,
+    REVOCATION_DB_UNKNOWN = 2 // Emissor fora da base ou CRL com a próxima atualização vencida
+};
+
+// Contexto de verificação reutilizável, criado uma vez a partir das âncoras de confiança e das CRLs
+// e compartilhado por verificações concorrentes (ver createVerificationContext).
+struct VerificationContext
+{
+    STACK_OF(X509) *trustAnchors = nullptr; // Certificados confiáveis já decodificados
+    X509_STORE *store = nullptr;            // Âncoras + CRLs atuais; substituído por inteiro ao atualizar as CRLs
+    std::mutex storeMutex;                  // Protege apenas a troca do ponteiro "store"
+};
+
+// Número de série revogado no índice de uma CRL. Seriais de até 20 octetos (RFC 5280) ficam
+// no próprio slot, junto com a data e o motivo da revogação, sem alocações por entrada.
+struct RevokedSerialEntry
+{
+    unsigned char serial[20]; // Octetos do número de série (conteúdo do INTEGER)
+    uint8_t serialLength;     // Número de octetos usados; o bit 0x80 marca serial negativo
+    int8_t reason;            // Motivo da revogação (CRL_REASON_*), -1 se ausente
+    uint8_t occupied;         // 1 se o slot está em uso
+    uint8_t padding;
+    uint32_t tag;             // Bits altos do hash, para descartar comparações sem ler o serial
+    int64_t revocationDate;   // Data da revogação em segundos desde a época (UTC)
+};
+
+// Tabela de endereçamento aberto (sondagem linear, ocupação máxima de 50%) com os seriais
+// revogados de uma CRL, montada uma vez por CRL carregada no cache.
+struct RevokedSerialIndex
+{
+    std::vector<RevokedSerialEntry> slots; // Capacidade em potência de 2
+    size_t count = 0;                      // Entradas ocupadas
+    bool hasLongSerials = false;           // A CRL tem seriais com mais de 20 octetos, fora do índice
+};
+
+// Resultado da consulta de um número de série em uma CRL
+struct RevocationEntry
+{
+    int64_t revocationDate; // Segundos desde a época (UTC)
+    int reason;             // Motivo da revogação (CRL_REASON_*), -1 se ausente
+};
+
+// Entrada do cache de CRLs decodificadas, indexado pelo SHA-256 dos bytes da CRL
+struct CrlCacheEntry
+{
+    X509_CRL *crl = nullptr; // Referência mantida pelo cache
+    size_t size = 0;         // Tamanho codificado da CRL mais o do índice, usado no orçamento de memória
+    time_t nextUpdate = 0;   // Momento da próxima atualização; 0 se a CRL não informar
+    uint64_t lastUse = 0;    // Relógio lógico do último acesso, para descartar a menos usada
+    std::shared_ptr<const RevokedSerialIndex> revokedIndex; // Montado antes de a CRL entrar no cache
+};
+
+// Contadores do cache de CRLs
+struct CrlCacheStats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t entries;
+    size_t bytes;
+    size_t budget;
+};
+
+// Contexto de biblioteca do processo: inicialização única do OpenSSL e referências aos algoritmos usados
+// nas verificações, buscados (EVP_*_fetch) uma vez em vez de implicitamente a cada operação.
+struct CryptoLibraryContext
+{
+    OSSL_LIB_CTX *libraryContext = nullptr; // nullptr é o contexto padrão, usado internamente por X509/CMS
+    EVP_MD *sha256 = nullptr;
+    EVP_MD *sha512 = nullptr;
+    EVP_SIGNATURE *rsaSignature = nullptr;
+    EVP_SIGNATURE *ecdsaSignature = nullptr;
+    EVP_KEYMGMT *rsaKeyManagement = nullptr;
+    EVP_KEYMGMT *ecKeyManagement = nullptr;
+};
+
 extern "C"
 {
 
@@ -146,10 +347,267 @@ extern "C"
         X509_free(certificate);
     }
 
+    static CryptoLibraryContext cryptoLibrary;
+    static std::once_flag cryptoLibraryOnce;
+
+    // Libera as referências buscadas, antes da limpeza do próprio OpenSSL na saída do processo
+    static void releaseCryptoLibraryContext()
+    {
+        EVP_MD_free(cryptoLibrary.sha256);
+        EVP_MD_free(cryptoLibrary.sha512);
+        EVP_SIGNATURE_free(cryptoLibrary.rsaSignature);
+        EVP_SIGNATURE_free(cryptoLibrary.ecdsaSignature);
+        EVP_KEYMGMT_free(cryptoLibrary.rsaKeyManagement);
+        EVP_KEYMGMT_free(cryptoLibrary.ecKeyManagement);
+        cryptoLibrary = CryptoLibraryContext();
+    }
+
+    /**
+     * Retorna o contexto de biblioteca do processo, inicializando o OpenSSL e buscando os algoritmos
+     * (SHA-256/512, RSA, ECDSA) na primeira chamada. As chamadas seguintes custam uma leitura atômica.
+     * Manter as referências buscadas deixa esses algoritmos no cache de métodos do contexto padrão,
+     * de modo que as buscas internas de X509_verify_cert e CMS_verify sempre os encontram.
+     *
+     * @return o contexto de biblioteca, válido até o fim do processo. Um algoritmo indisponível fica nulo.
+     */
+    const CryptoLibraryContext *getCryptoLibraryContext()
+    {
+        std::call_once(cryptoLibraryOnce, []()
+                       {
+                           OPENSSL_init_crypto(OPENSSL_INIT_LOAD_CONFIG | OPENSSL_INIT_ADD_ALL_CIPHERS |
+                                                   OPENSSL_INIT_ADD_ALL_DIGESTS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS,
+                                               NULL);
+                           OSSL_LIB_CTX *libraryContext = cryptoLibrary.libraryContext;
+                           cryptoLibrary.sha256 = EVP_MD_fetch(libraryContext, "SHA2-256", nullptr);
+                           cryptoLibrary.sha512 = EVP_MD_fetch(libraryContext, "SHA2-512", nullptr);
+                           cryptoLibrary.rsaSignature = EVP_SIGNATURE_fetch(libraryContext, "RSA", nullptr);
+                           cryptoLibrary.ecdsaSignature = EVP_SIGNATURE_fetch(libraryContext, "ECDSA", nullptr);
+                           cryptoLibrary.rsaKeyManagement = EVP_KEYMGMT_fetch(libraryContext, "RSA", nullptr);
+                           cryptoLibrary.ecKeyManagement = EVP_KEYMGMT_fetch(libraryContext, "EC", nullptr);
+                           if (!cryptoLibrary.sha256 || !cryptoLibrary.sha512 || !cryptoLibrary.rsaSignature ||
+                               !cryptoLibrary.ecdsaSignature || !cryptoLibrary.rsaKeyManagement || !cryptoLibrary.ecKeyManagement)
+                           {
+                               fprintf(stderr, "Falha ao buscar algoritmos do OpenSSL\n");
+                           }
+                           // Registrado depois de OPENSSL_init_crypto, então executa antes de OPENSSL_cleanup
+                           atexit(releaseCryptoLibraryContext);
+                       });
+        return &cryptoLibrary;
+    }
+
     // Função para inicializar a biblioteca OpenSSL para criptografia
     void startOpenSSL()
     {
-        OPENSSL_init_crypto(0, NULL);
+        getCryptoLibraryContext();
+    }
+
+    // Retorna uma view do conteúdo de um ByteArray (vazia se o ByteArray for nulo)
+    ByteView byteViewOf(const ByteArray *bytes)
+    {
+        if (bytes == nullptr)
+        {
+            return {};
+        }
+        return {bytes->data, bytes->len};
+    }
+
+    /**
+     * Mapeia um arquivo em memória, somente para leitura, para que CRLs e certificados grandes possam ser
+     * decodificados sem copiá-los para um ByteArray.
+     *
+     * @param path O caminho do arquivo.
+     *
+     * @return o mapeamento, a ser liberado com unmapFile, ou nullptr se o arquivo não puder ser aberto,
+     * estiver vazio ou não puder ser mapeado.
+     */
+    MappedFile *mapFile(const char *path)
+    {
+        int fd = path != nullptr ? open(path, O_RDONLY | O_CLOEXEC) : -1;
+        if (fd == -1)
+        {
+            return nullptr;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            close(fd);
+            return nullptr;
+        }
+        void *address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // O mapeamento continua válido sem o descritor
+        if (address == MAP_FAILED)
+        {
+            return nullptr;
+        }
+        MappedFile *mapped = new MappedFile;
+        mapped->address = address;
+        mapped->len = (size_t)info.st_size;
+        return mapped;
+    }
+
+    // Retorna uma view do conteúdo de um arquivo mapeado, válida até unmapFile
+    ByteView mappedFileView(const MappedFile *mapped)
+    {
+        if (mapped == nullptr)
+        {
+            return {};
+        }
+        return {static_cast<const unsigned char *>(mapped->address), mapped->len};
+    }
+
+    // Desfaz o mapeamento criado por mapFile
+    void unmapFile(MappedFile *mapped)
+    {
+        if (mapped == nullptr)
+        {
+            return;
+        }
+        munmap(mapped->address, mapped->len);
+        delete mapped;
+    }
+
+    /**
+     * Detecta a codificação de um objeto sem copiá-lo. DER é reconhecido pela etiqueta inicial (SEQUENCE,
+     * 0x30) e por um comprimento que cabe no buffer ou indefinido (BER, validado depois pelo d2i); PEM,
+     * pela armadura "-----BEGIN ".
+     *
+     * @param bytes Os bytes do objeto.
+     *
+     * @return ENCODING_DER, ENCODING_PEM ou ENCODING_UNKNOWN.
+     */
+    EncodingFormat detectEncoding(ByteView bytes)
+    {
+        if (bytes.data == nullptr || bytes.len < 2)
+        {
+            return ENCODING_UNKNOWN;
+        }
+        if (bytes.data[0] == 0x30)
+        {
+            size_t header = 2;
+            size_t length = bytes.data[1];
+            if (length & 0x80)
+            {
+                size_t lengthOctets = length & 0x7f;
+                if (lengthOctets == 0)
+                {
+                    // Comprimento indefinido (BER, p.ex. cms -sign -stream): o fim só é conhecido pelo d2i
+                    return ENCODING_DER;
+                }
+                if (lengthOctets > sizeof(size_t) || bytes.len < 2 + lengthOctets)
+                {
+                    return ENCODING_UNKNOWN;
+                }
+                length = 0;
+                for (size_t i = 0; i < lengthOctets; i++)
+                {
+                    length = (length << 8) | bytes.data[2 + i];
+                }
+                header += lengthOctets;
+            }
+            if (length <= bytes.len - header)
+            {
+                return ENCODING_DER;
+            }
+            return ENCODING_UNKNOWN;
+        }
+        static const char armor[] = "-----BEGIN ";
+        if (memmem(bytes.data, bytes.len, armor, sizeof(armor) - 1) != nullptr)
+        {
+            return ENCODING_PEM;
+        }
+        return ENCODING_UNKNOWN;
+    }
+
+    /**
+     * Decodifica um certificado X.509 a partir de uma view. DER é decodificado direto com d2i_X509, sem
+     * BIO nem cópia; um BIO só é criado quando a armadura PEM está presente.
+     *
+     * @param bytes Os bytes do certificado, em PEM ou DER.
+     *
+     * @return o certificado, a ser liberado com X509_free, ou nullptr em caso de erro.
+     */
+    X509 *decodeCertificateView(ByteView bytes)
+    {
+        getCryptoLibraryContext();
+
+        switch (detectEncoding(bytes))
+        {
+        case ENCODING_DER:
+        {
+            const unsigned char *cursor = bytes.data;
+            return d2i_X509(nullptr, &cursor, (long)bytes.len);
+        }
+        case ENCODING_PEM:
+        {
+            BIO *bio = BIO_new_mem_buf(bytes.data, (int)bytes.len);
+            X509 *certificate = bio != nullptr ? PEM_read_bio_X509(bio, nullptr, nullptr, nullptr) : nullptr;
+            BIO_free(bio);
+            return certificate;
+        }
+        default:
+            return nullptr;
+        }
+    }
+
+    /**
+     * Decodifica uma CRL a partir de uma view, com d2i_X509_CRL direto para DER e PEM apenas com armadura.
+     *
+     * @param bytes Os bytes da CRL, em PEM ou DER.
+     *
+     * @return a CRL, a ser liberada com X509_CRL_free, ou nullptr em caso de erro.
+     */
+    X509_CRL *decodeCrlView(ByteView bytes)
+    {
+        getCryptoLibraryContext();
+
+        switch (detectEncoding(bytes))
+        {
+        case ENCODING_DER:
+        {
+            const unsigned char *cursor = bytes.data;
+            return d2i_X509_CRL(nullptr, &cursor, (long)bytes.len);
+        }
+        case ENCODING_PEM:
+        {
+            BIO *bio = BIO_new_mem_buf(bytes.data, (int)bytes.len);
+            X509_CRL *crl = bio != nullptr ? PEM_read_bio_X509_CRL(bio, nullptr, nullptr, nullptr) : nullptr;
+            BIO_free(bio);
+            return crl;
+        }
+        default:
+            return nullptr;
+        }
+    }
+
+    /**
+     * Decodifica uma assinatura CMS a partir de uma view, com d2i_CMS_ContentInfo direto para DER e PEM
+     * apenas com armadura.
+     *
+     * @param bytes Os bytes da assinatura, em PEM ou DER.
+     *
+     * @return a assinatura, a ser liberada com CMS_ContentInfo_free, ou nullptr em caso de erro.
+     */
+    CMS_ContentInfo *decodeSignatureView(ByteView bytes)
+    {
+        getCryptoLibraryContext();
+
+        switch (detectEncoding(bytes))
+        {
+        case ENCODING_DER:
+        {
+            const unsigned char *cursor = bytes.data;
+            return d2i_CMS_ContentInfo(nullptr, &cursor, (long)bytes.len);
+        }
+        case ENCODING_PEM:
+        {
+            BIO *bio = BIO_new_mem_buf(bytes.data, (int)bytes.len);
+            CMS_ContentInfo *signature = bio != nullptr ? PEM_read_bio_CMS(bio, nullptr, nullptr, nullptr) : nullptr;
+            BIO_free(bio);
+            return signature;
+        }
+        default:
+            return nullptr;
+        }
     }
 
 void printStackTrace() {
@@ -172,12 +630,9 @@ void printStackTrace() {
         BIO *crlbio = nullptr, *outbio = nullptr;
 
         /* ---------------------------------------------------------- *
-         * These function calls initialize openssl for correct work.  *
+         * This call initializes openssl for correct work.            *
          * ---------------------------------------------------------- */
-        OpenSSL_add_all_algorithms();
-        OpenSSL_add_all_ciphers();
-        OpenSSL_add_all_digests();
-        ERR_load_crypto_strings();
+        getCryptoLibraryContext();
 
         crlbio = BIO_new_mem_buf(pem->data, pem->len);
         if (!crlbio)
@@ -218,10 +673,9 @@ void printStackTrace() {
         BIO *outbio = nullptr;
 
         /* ---------------------------------------------------------- *
-         * These function calls initialize openssl for correct work.  *
+         * This call initializes openssl for correct work.            *
          * ---------------------------------------------------------- */
-        OpenSSL_add_all_algorithms();
-        ERR_load_crypto_strings();
+        getCryptoLibraryContext();
 
         /* Create the Input/Output BIO's */
         certbio = BIO_new_mem_buf(pem->data, pem->len);
@@ -259,37 +713,13 @@ void printStackTrace() {
 
     X509 *decode_x509(ByteArray *bytes)
     {
-        X509 *px509{
-            nullptr};
-
-        const unsigned char *buf = reinterpret_cast<
-            const unsigned char *>(bytes->data);
-        std::string s(reinterpret_cast<char const *>(bytes->data));
-
-        if (s.find("-----BEGIN CERTIFICATE-----") != std::string::npos)
-            px509 = pem2x509(bytes);
-        else
-            px509 = d2i_X509(nullptr, &buf, bytes->len);
-
-        return px509;
+        return decodeCertificateView(byteViewOf(bytes));
     }
 
     // Decodifica crl codificada em PEM ou DER
     X509_CRL *decode_crl(ByteArray *bytes)
     {
-        X509_CRL *pcrl{
-            nullptr};
-
-        const unsigned char *buf = reinterpret_cast<
-            const unsigned char *>(bytes->data);
-        std::string s(reinterpret_cast<char const *>(bytes->data));
-
-        if (s.find("-----BEGIN X509 CRL-----") != std::string::npos)
-            pcrl = pem2crl(bytes);
-        else
-            pcrl = d2i_X509_CRL(nullptr, &buf, bytes->len);
-
-        return pcrl;
+        return decodeCrlView(byteViewOf(bytes));
     }
     // Fim do código depreciado;
 
@@ -302,35 +732,13 @@ void printStackTrace() {
      */
     CMS_ContentInfo *decodeSignature(ByteArray *signature)
     {
-        CMS_ContentInfo *decodedCMSSignature = nullptr;
-        BIO *signatureMemoryBuffer = nullptr;
-
-        // Inicializa OpenSSL com algoritmos, cifras e digesters
-        OpenSSL_add_all_algorithms();
-        OpenSSL_add_all_ciphers();
-        OpenSSL_add_all_digests();
-        ERR_load_crypto_strings();
-
-        // Cria um BIO de buffer de memória para armazenar os dados da assinatura
-        signatureMemoryBuffer = BIO_new_mem_buf(signature->data, signature->len);
-        if (signatureMemoryBuffer == nullptr)
-        {
-            fprintf(stderr, "Erro ao criar o BIO de buffer de memória\n");
-            return nullptr;
-        }
-
-        // Decodifica a assinatura usando a função d2i_CMS_bio
-        decodedCMSSignature = d2i_CMS_bio(signatureMemoryBuffer, nullptr);
+        CMS_ContentInfo *decodedCMSSignature = decodeSignatureView(byteViewOf(signature));
         if (decodedCMSSignature == nullptr)
         {
             fprintf(stderr, "Erro ao decodificar a assinatura CMS\n");
-            BIO_free(signatureMemoryBuffer);
             return nullptr;
         }
 
-        // Libera o BIO de buffer de memória
-        BIO_free(signatureMemoryBuffer);
-
         return decodedCMSSignature;
     }
 
@@ -343,42 +751,8 @@ void printStackTrace() {
      */
     X509 *decodeCertificate(ByteArray *x509Certificate)
     {
-        // Inicializa OpenSSL com algoritmos, cifras e digesters
-        OpenSSL_add_all_algorithms();
-        OpenSSL_add_all_ciphers();
-        OpenSSL_add_all_digests();
-        ERR_load_crypto_strings();
-
-        X509 *certificate = nullptr;
-
-        // Verifica se o objeto ByteArray é válido e contém dados
-        if (x509Certificate == nullptr || x509Certificate->data == nullptr || x509Certificate->len <= 0)
-        {
-            return nullptr;
-        }
-
-        // Cria um BIO de buffer de memória com os dados do certificado
-        BIO *bio = BIO_new_mem_buf(x509Certificate->data, x509Certificate->len);
-
-        if (bio != nullptr)
-        {
-            // Tenta decodificar o certificado no formato PEM
-            if (PEM_read_bio_X509(bio, &certificate, nullptr, nullptr) == nullptr)
-            {
-                // Se falhar como PEM, tenta decodificar no formato DER
-                BIO_reset(bio);
-                if (d2i_X509_bio(bio, &certificate) == nullptr)
-                {
-                    // Falha na decodificação como DER também
-                    return nullptr;
-                }
-            }
-
-            // Libera o BIO
-            BIO_free(bio);
-        }
-
-        return certificate;
+        // A codificação é detectada pelos primeiros bytes; DER é decodificado sem BIO nem cópia
+        return decodeCertificateView(byteViewOf(x509Certificate));
     }
 
     /**
@@ -392,58 +766,441 @@ void printStackTrace() {
      */
     X509_CRL *decodeCRLs(ByteArray *bytesFromCrl)
     {
-        // Verifica se o objeto ByteArray de entrada é válido e contém dados válidos
-        if (bytesFromCrl == nullptr || bytesFromCrl->data == nullptr || bytesFromCrl->len <= 0)
-        {
-            return nullptr;
-        }
-
-        X509_CRL *decodedCrl = nullptr; // Inicializa o ponteiro de CRL como nulo
-
-        const unsigned char *data = bytesFromCrl->data;
-
-        // Valida a entrada e cria um BIO de buffer de memória
-        BIO *bio = BIO_new_mem_buf(data, bytesFromCrl->len);
-
-        // Verifica se o BIO foi criado com sucesso
-        if (bio == nullptr)
-        {
-            return nullptr;
-        }
+        // A codificação é detectada pelos primeiros bytes; DER é decodificado sem BIO nem cópia
+        return decodeCrlView(byteViewOf(bytesFromCrl));
+    }
 
-        // Tenta decodificar como DER (formato binário)
-        d2i_X509_CRL_bio(bio, &decodedCrl);
+    static std::mutex crlCacheMutex;
+    static std::unordered_map<std::string, CrlCacheEntry> crlCache;
+    static std::unordered_map<const X509_CRL *, std::string> crlCacheKeys; // CRL em cache -> chave em crlCache
+    static size_t crlCacheBytes = 0;
+    static size_t crlCacheBudget = 64 * 1024 * 1024;
+    static uint64_t crlCacheClock = 0;
+    static uint64_t crlCacheHits = 0;
+    static uint64_t crlCacheMisses = 0;
+    static uint64_t crlCacheEvictions = 0;
 
-        // Se a decodificação como DER falhar, tenta o formato PEM (formato base64)
-        if (decodedCrl == nullptr)
+    /**
+     * Converte um ASN1_TIME em time_t (UTC).
+     *
+     * @param time O horário no formato ASN.1. Pode ser nulo.
+     *
+     * @return o horário em segundos desde a época, ou 0 se o horário for nulo ou inválido.
+     */
+    time_t asn1TimeToEpoch(const ASN1_TIME *time)
+    {
+        struct tm parsed;
+        if (time == nullptr || ASN1_TIME_to_tm(time, &parsed) != 1)
         {
-            BIO_reset(bio);
-            PEM_read_bio_X509_CRL(bio, &decodedCrl, NULL, NULL);
+            return 0;
         }
-
-        BIO_free(bio); // Libera o BIO
-
-        return decodedCrl; // Retorna a CRL decodificada (pode ser nullptr se a decodificação falhar)
+        return timegm(&parsed);
     }
 
     /**
-     * Esta função adiciona um certificado de signatário a uma assinatura CMS.
+     * Remove uma entrada do cache de CRLs. Deve ser chamada com crlCacheMutex travado.
      *
-     * @param signature Um array de bytes representando a assinatura CMS à qual o certificado do signatário
-     * precisa ser adicionado.
-     * @param signerCertificate Um array de bytes contendo a representação binária do certificado X.509 do signatário.
+     * @param entry O iterador da entrada a ser removida.
      *
-     * @return Um ponteiro CMS_ContentInfo, que representa a assinatura com o certificado do signatário adicionado a ela.
+     * @return o iterador para a entrada seguinte.
      */
-    CMS_ContentInfo *addCertificateToSignature(ByteArray *signature, ByteArray *signerCertificate)
+    std::unordered_map<std::string, CrlCacheEntry>::iterator eraseCrlCacheEntryLocked(std::unordered_map<std::string, CrlCacheEntry>::iterator entry)
     {
-        // Decodifica o certificado do signatário
-        X509 *signerX509Certificate = decodeCertificate(signerCertificate);
-        if (!signerX509Certificate)
-        {
-            fprintf(stderr, "Erro ao decodificar o certificado X509\n");
-            return nullptr;
-        }
+        crlCacheBytes -= entry->second.size;
+        crlCacheKeys.erase(entry->second.crl);
+        X509_CRL_free(entry->second.crl);
+        crlCacheEvictions++;
+        return crlCache.erase(entry);
+    }
+
+    /**
+     * Remove do cache as CRLs cuja próxima atualização já passou e, se ainda for preciso, as menos
+     * usadas recentemente até que "needed" bytes caibam no orçamento. Deve ser chamada com crlCacheMutex travado.
+     *
+     * @param needed O número de bytes que a próxima inserção vai ocupar.
+     */
+    void evictCrlCacheLocked(size_t needed)
+    {
+        time_t now = time(nullptr);
+        for (auto it = crlCache.begin(); it != crlCache.end();)
+        {
+            if (it->second.nextUpdate != 0 && it->second.nextUpdate < now)
+            {
+                it = eraseCrlCacheEntryLocked(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        while (!crlCache.empty() && crlCacheBytes + needed > crlCacheBudget)
+        {
+            auto oldest = crlCache.begin();
+            for (auto it = crlCache.begin(); it != crlCache.end(); ++it)
+            {
+                if (it->second.lastUse < oldest->second.lastUse)
+                {
+                    oldest = it;
+                }
+            }
+            eraseCrlCacheEntryLocked(oldest);
+        }
+    }
+
+    /**
+     * Calcula o hash (FNV-1a de 64 bits, com mistura final) dos octetos de um número de série.
+     *
+     * @param serial Os octetos do número de série.
+     * @param length O número de octetos.
+     *
+     * @return o hash de 64 bits.
+     */
+    uint64_t hashSerial(const unsigned char *serial, size_t length)
+    {
+        uint64_t hash = 1469598103934665603ULL;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash = (hash ^ serial[i]) * 1099511628211ULL;
+        }
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /**
+     * Obtém o motivo de revogação de uma entrada de CRL.
+     *
+     * @param revoked A entrada revogada.
+     *
+     * @return o motivo (CRL_REASON_*), ou -1 se a extensão não estiver presente.
+     */
+    int getRevocationReason(const X509_REVOKED *revoked)
+    {
+        int critical = 0;
+        ASN1_ENUMERATED *reason = (ASN1_ENUMERATED *)X509_REVOKED_get_ext_d2i(revoked, NID_crl_reason, &critical, nullptr);
+        if (reason == nullptr)
+        {
+            return -1;
+        }
+        int value = (int)ASN1_ENUMERATED_get(reason);
+        ASN1_ENUMERATED_free(reason);
+        return value;
+    }
+
+    /**
+     * Procura um número de série no índice. O serial deve ter no máximo 20 octetos.
+     *
+     * @return o slot encontrado, ou nullptr se o serial não estiver no índice.
+     */
+    const RevokedSerialEntry *findRevokedSerialSlot(const RevokedSerialIndex *index, const ASN1_INTEGER *serial)
+    {
+        const unsigned char *data = ASN1_STRING_get0_data(serial);
+        size_t length = ASN1_STRING_length(serial);
+        uint8_t storedLength = (uint8_t)(length | (ASN1_STRING_type(serial) == V_ASN1_NEG_INTEGER ? 0x80 : 0));
+        uint64_t hash = hashSerial(data, length);
+        uint32_t tag = (uint32_t)(hash >> 32);
+        size_t mask = index->slots.size() - 1;
+
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+        {
+            const RevokedSerialEntry &entry = index->slots[slot];
+            if (!entry.occupied)
+            {
+                return nullptr;
+            }
+            if (entry.tag == tag && entry.serialLength == storedLength && memcmp(entry.serial, data, length) == 0)
+            {
+                return &entry;
+            }
+        }
+    }
+
+    /**
+     * Monta o índice de seriais revogados de uma CRL: uma passagem sobre as entradas revogadas, copiando
+     * serial, data e motivo para slots contíguos.
+     *
+     * @param crl A CRL decodificada.
+     *
+     * @return o índice montado.
+     */
+    std::shared_ptr<const RevokedSerialIndex> buildRevokedSerialIndex(X509_CRL *crl)
+    {
+        auto index = std::make_shared<RevokedSerialIndex>();
+        STACK_OF(X509_REVOKED) *revokedList = X509_CRL_get_REVOKED(crl);
+        int revokedCount = revokedList ? sk_X509_REVOKED_num(revokedList) : 0;
+
+        size_t capacity = 16;
+        while (capacity < (size_t)revokedCount * 2)
+        {
+            capacity *= 2;
+        }
+        index->slots.assign(capacity, RevokedSerialEntry{});
+
+        for (int i = 0; i < revokedCount; i++)
+        {
+            const X509_REVOKED *revoked = sk_X509_REVOKED_value(revokedList, i);
+            const ASN1_INTEGER *serial = X509_REVOKED_get0_serialNumber(revoked);
+            size_t length = ASN1_STRING_length(serial);
+            if (length > sizeof(RevokedSerialEntry::serial))
+            {
+                index->hasLongSerials = true;
+                continue;
+            }
+            if (findRevokedSerialSlot(index.get(), serial) != nullptr)
+            {
+                continue; // Serial repetido: vale a primeira ocorrência
+            }
+
+            const unsigned char *data = ASN1_STRING_get0_data(serial);
+            uint64_t hash = hashSerial(data, length);
+            size_t mask = capacity - 1;
+            size_t slot = hash & mask;
+            while (index->slots[slot].occupied)
+            {
+                slot = (slot + 1) & mask;
+            }
+
+            RevokedSerialEntry &entry = index->slots[slot];
+            memcpy(entry.serial, data, length);
+            entry.serialLength = (uint8_t)(length | (ASN1_STRING_type(serial) == V_ASN1_NEG_INTEGER ? 0x80 : 0));
+            entry.reason = (int8_t)getRevocationReason(revoked);
+            entry.occupied = 1;
+            entry.tag = (uint32_t)(hash >> 32);
+            entry.revocationDate = asn1TimeToEpoch(X509_REVOKED_get0_revocationDate(revoked));
+            index->count++;
+        }
+        return index;
+    }
+
+    /**
+     * Obtém uma CRL decodificada a partir do cache de CRLs, decodificando-a apenas na primeira vez que
+     * os mesmos bytes são vistos. A chave do cache é o SHA-256 dos bytes, de modo que CRLs republicadas
+     * geram novas entradas. CRLs com a próxima atualização vencida não são mantidas no cache.
+     *
+     * @param bytesFromCrl Os bytes da CRL em PEM ou DER, por exemplo de um arquivo mapeado com mapFile.
+     * Os bytes só são lidos durante a chamada; a CRL em cache não aponta para eles.
+     *
+     * @return Uma nova referência para a CRL decodificada, que deve ser liberada com X509_CRL_free
+     * (como o retorno de decodeCRLs), ou nullptr se a decodificação falhar.
+     */
+    X509_CRL *getCachedCRLView(ByteView bytesFromCrl)
+    {
+        if (bytesFromCrl.data == nullptr || bytesFromCrl.len == 0)
+        {
+            return nullptr;
+        }
+
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLength = 0;
+        if (EVP_Digest(bytesFromCrl.data, bytesFromCrl.len, digest, &digestLength, getCryptoLibraryContext()->sha256, nullptr) != 1)
+        {
+            return decodeCrlView(bytesFromCrl);
+        }
+        std::string key(reinterpret_cast<char *>(digest), digestLength);
+
+        {
+            std::lock_guard<std::mutex> lock(crlCacheMutex);
+            auto found = crlCache.find(key);
+            if (found != crlCache.end())
+            {
+                X509_CRL *crl = found->second.crl;
+                X509_CRL_up_ref(crl);
+                crlCacheHits++;
+                if (found->second.nextUpdate != 0 && found->second.nextUpdate < time(nullptr))
+                {
+                    // Vencida: entrega a CRL ao chamador, mas não a mantém mais no cache
+                    eraseCrlCacheEntryLocked(found);
+                }
+                else
+                {
+                    found->second.lastUse = ++crlCacheClock;
+                }
+                return crl;
+            }
+            crlCacheMisses++;
+        }
+
+        // Decodifica fora da trava: CRLs grandes levam dezenas de milissegundos
+        X509_CRL *decodedCrl = decodeCrlView(bytesFromCrl);
+        if (decodedCrl == nullptr)
+        {
+            return nullptr;
+        }
+
+        time_t nextUpdate = asn1TimeToEpoch(X509_CRL_get0_nextUpdate(decodedCrl));
+        if (nextUpdate != 0 && nextUpdate < time(nullptr))
+        {
+            return decodedCrl;
+        }
+
+        // Ordena as entradas revogadas e monta o índice antes de publicar a CRL: depois disso
+        // X509_verify_cert ordenaria a mesma pilha em outra thread enquanto o índice a percorre
+        sk_X509_REVOKED_sort(X509_CRL_get_REVOKED(decodedCrl));
+        std::shared_ptr<const RevokedSerialIndex> revokedIndex = buildRevokedSerialIndex(decodedCrl);
+        size_t entrySize = bytesFromCrl.len + sizeof(RevokedSerialIndex) + revokedIndex->slots.capacity() * sizeof(RevokedSerialEntry);
+
+        std::lock_guard<std::mutex> lock(crlCacheMutex);
+        auto found = crlCache.find(key);
+        if (found != crlCache.end())
+        {
+            // Outra thread decodificou a mesma CRL enquanto isso; usa a que já está no cache
+            X509_CRL_free(decodedCrl);
+            decodedCrl = found->second.crl;
+            X509_CRL_up_ref(decodedCrl);
+            found->second.lastUse = ++crlCacheClock;
+            return decodedCrl;
+        }
+        if (entrySize > crlCacheBudget)
+        {
+            return decodedCrl;
+        }
+
+        evictCrlCacheLocked(entrySize);
+        CrlCacheEntry entry;
+        entry.crl = decodedCrl;
+        entry.size = entrySize;
+        entry.nextUpdate = nextUpdate;
+        entry.revokedIndex = std::move(revokedIndex);
+        entry.lastUse = ++crlCacheClock;
+        X509_CRL_up_ref(decodedCrl);
+        crlCache.emplace(key, entry);
+        crlCacheKeys.emplace(decodedCrl, key);
+        crlCacheBytes += entry.size;
+        return decodedCrl;
+    }
+
+    /**
+     * Igual a getCachedCRLView, para uma CRL em um ByteArray.
+     *
+     * @param bytesFromCrl Um ponteiro para um objeto ByteArray que contém a CRL em PEM ou DER.
+     *
+     * @return Uma nova referência para a CRL decodificada, a ser liberada com X509_CRL_free, ou nullptr.
+     */
+    X509_CRL *getCachedCRL(ByteArray *bytesFromCrl)
+    {
+        return getCachedCRLView(byteViewOf(bytesFromCrl));
+    }
+
+    /**
+     * Define o orçamento de memória do cache de CRLs, medido pelo tamanho codificado das CRLs mais o dos
+     * seus índices de seriais, e descarta entradas até que o cache caiba no novo orçamento.
+     *
+     * @param budgetBytes O número máximo de bytes mantidos no cache. 0 desativa o cache.
+     */
+    void setCrlCacheBudget(size_t budgetBytes)
+    {
+        std::lock_guard<std::mutex> lock(crlCacheMutex);
+        crlCacheBudget = budgetBytes;
+        evictCrlCacheLocked(0);
+    }
+
+    /**
+     * Libera todas as CRLs mantidas no cache. Referências já entregues aos chamadores continuam válidas.
+     */
+    void clearCrlCache()
+    {
+        std::lock_guard<std::mutex> lock(crlCacheMutex);
+        for (auto &entry : crlCache)
+        {
+            X509_CRL_free(entry.second.crl);
+        }
+        crlCacheEvictions += crlCache.size();
+        crlCache.clear();
+        crlCacheKeys.clear();
+        crlCacheBytes = 0;
+    }
+
+    /**
+     * Obtém os contadores do cache de CRLs.
+     *
+     * @return uma estrutura CrlCacheStats com acertos, faltas, descartes, entradas e bytes em uso.
+     */
+    CrlCacheStats getCrlCacheStats()
+    {
+        std::lock_guard<std::mutex> lock(crlCacheMutex);
+        return CrlCacheStats{crlCacheHits, crlCacheMisses, crlCacheEvictions, crlCache.size(), crlCacheBytes, crlCacheBudget};
+    }
+
+    /**
+     * Verifica se um número de série consta em uma CRL. Para CRLs obtidas de getCachedCRL a consulta usa o
+     * índice de seriais revogados da CRL, montado antes de a CRL entrar no cache e mantido enquanto ela
+     * estiver lá; para as demais (ou seriais com mais de 20 octetos) usa X509_CRL_get0_by_serial.
+     *
+     * @param crl A CRL decodificada.
+     * @param serial O número de série procurado.
+     * @param entry Recebe a data e o motivo da revogação quando o serial é encontrado. Pode ser nulo.
+     *
+     * @return true se o serial consta na CRL (inclusive com motivo removeFromCRL), false caso contrário.
+     */
+    bool lookupRevokedSerial(X509_CRL *crl, const ASN1_INTEGER *serial, RevocationEntry *entry)
+    {
+        if (crl == nullptr || serial == nullptr)
+        {
+            return false;
+        }
+
+        std::shared_ptr<const RevokedSerialIndex> index;
+        if ((size_t)ASN1_STRING_length(serial) <= sizeof(RevokedSerialEntry::serial))
+        {
+            std::lock_guard<std::mutex> lock(crlCacheMutex);
+            auto key = crlCacheKeys.find(crl);
+            if (key != crlCacheKeys.end())
+            {
+                index = crlCache[key->second].revokedIndex;
+            }
+        }
+
+        if (index)
+        {
+            const RevokedSerialEntry *found = findRevokedSerialSlot(index.get(), serial);
+            if (found != nullptr)
+            {
+                if (entry)
+                {
+                    entry->revocationDate = found->revocationDate;
+                    entry->reason = found->reason;
+                }
+                return true;
+            }
+            if (!index->hasLongSerials)
+            {
+                return false;
+            }
+        }
+
+        X509_REVOKED *revoked = nullptr;
+        if (X509_CRL_get0_by_serial(crl, &revoked, serial) == 0 || revoked == nullptr)
+        {
+            return false;
+        }
+        if (entry)
+        {
+            entry->revocationDate = asn1TimeToEpoch(X509_REVOKED_get0_revocationDate(revoked));
+            entry->reason = getRevocationReason(revoked);
+        }
+        return true;
+    }
+
+    /**
+     * Esta função adiciona um certificado de signatário a uma assinatura CMS.
+     *
+     * @param signature Um array de bytes representando a assinatura CMS à qual o certificado do signatário
+     * precisa ser adicionado.
+     * @param signerCertificate Um array de bytes contendo a representação binária do certificado X.509 do signatário.
+     *
+     * @return Um ponteiro CMS_ContentInfo, que representa a assinatura com o certificado do signatário adicionado a ela.
+     */
+    CMS_ContentInfo *addCertificateToSignature(ByteArray *signature, ByteArray *signerCertificate)
+    {
+        // Decodifica o certificado do signatário
+        X509 *signerX509Certificate = decodeCertificate(signerCertificate);
+        if (!signerX509Certificate)
+        {
+            fprintf(stderr, "Erro ao decodificar o certificado X509\n");
+            return nullptr;
+        }
 
         // Decodifica a assinatura
         CMS_ContentInfo *decodedSignature = decodeSignature(signature);
@@ -522,7 +1279,7 @@ void printStackTrace() {
             }
 
             // Decodifica a CRL a partir dos bytes
-            crl = decodeCRLs(crlBytes);
+            crl = getCachedCRL(crlBytes);
             if (crl == nullptr)
             {
                 X509_STORE_free(store);
@@ -537,6 +1294,9 @@ void printStackTrace() {
                 X509_CRL_free(crl);
                 return;
             }
+
+            // O armazenamento mantém sua própria referência
+            X509_CRL_free(crl);
         }
     }
 
@@ -575,84 +1335,65 @@ void printStackTrace() {
     }
 
     /**
-     * Esta função verifica uma assinatura CMS usando uma cadeia de certificados e um buffer de mensagem.
+     * Cria um armazenamento X509_STORE com os certificados de uma pilha. O armazenamento guarda suas
+     * próprias referências, de modo que a pilha pode ser liberada em seguida.
      *
-     * @param bytesFromData Um array de bytes contendo os dados a serem verificados.
-     * @param signature Um array de bytes contendo a assinatura a ser verificada.
-     * @param certificate Um array de bytes contendo o certificado usado para assinar os dados.
-     * @param certificateChain Um array de ponteiros para ByteArrays representando a cadeia de certificados. O
-     * tamanho do array é dado por chainSize.
-     * @param chainSize O tamanho da cadeia de certificados, que é o número de certificados na cadeia.
+     * @param certificates A pilha de certificados já decodificados.
      *
-     * @return um objeto de resposta, que contém um valor booleano indicando se a assinatura é válida
-     * ou não, e uma string de mensagem fornecendo informações adicionais sobre o resultado da verificação.
+     * @return o armazenamento criado, ou nullptr em caso de erro.
      */
-    Response verifyCmsSignature(
-        ByteArray *bytesFromData,
-        ByteArray *signature,
-        ByteArray *certificate,
-        ByteArray **certificateChain,
-        size_t chainSize)
+    X509_STORE *createStoreFromCertificates(STACK_OF(X509) * certificates)
     {
-        OpenSSL_add_all_algorithms();
-        ERR_load_crypto_strings();
-
-        // Cria um novo objeto X509_STORE
-        X509_STORE *rootStore = X509_STORE_new();
-
-        if (rootStore == nullptr)
+        X509_STORE *store = X509_STORE_new();
+        if (store == nullptr)
         {
-            return {
-                false,
-                "Falha ao criar objeto X509_STORE"};
+            return nullptr;
         }
-
-        // Adiciona a cadeia de certificados ao armazenamento
-        addChainToStore(certificateChain, chainSize, rootStore);
-        if (!rootStore)
+        for (int i = 0; i < sk_X509_num(certificates); i++)
         {
-            X509_STORE_free(rootStore);
-            return {
-                false,
-                "Falha ao adicionar cadeia de certificados ao X509_STORE"};
+            if (X509_STORE_add_cert(store, sk_X509_value(certificates, i)) != 1)
+            {
+                X509_STORE_free(store);
+                return nullptr;
+            }
         }
+        return store;
+    }
 
+    /**
+     * Verifica uma assinatura CMS destacada contra um armazenamento já montado. O conteúdo é lido do BIO
+     * em blocos pelo próprio CMS_verify, de modo que um BIO de arquivo não é carregado inteiro na memória.
+     *
+     * @param rootStore O armazenamento com a cadeia de certificados.
+     * @param content O BIO com os dados assinados. Não é liberado pela função.
+     * @param signature A assinatura CMS em DER.
+     * @param certificate O certificado do signatário.
+     *
+     * @return um objeto Response com o resultado da verificação.
+     */
+    Response verifyCmsContentWithStore(X509_STORE *rootStore, BIO *content, ByteArray *signature, ByteArray *certificate)
+    {
         // Adiciona o certificado à assinatura
         CMS_ContentInfo *decodedSignature = addCertificateToSignature(signature, certificate);
 
         if (decodedSignature == nullptr)
         {
-            X509_STORE_free(rootStore);
             return {
                 false,
                 "Falha ao adicionar certificado à assinatura"};
         }
 
-        // Cria um novo objeto BIO para o buffer de mensagem
-        BIO *messageBuffer = BIO_new_mem_buf(bytesFromData->data, bytesFromData->len);
-
-        if (messageBuffer == nullptr)
-        {
-            CMS_ContentInfo_free(decodedSignature);
-            X509_STORE_free(rootStore);
-            return {
-                false,
-                "Falha ao criar objeto BIO"};
-        }
-
         // Verifica a assinatura
         int verificationResult = CMS_verify(
             decodedSignature,
             nullptr,
             rootStore,
-            messageBuffer,
+            content,
             nullptr,
             CMS_NO_SIGNER_CERT_VERIFY | CMS_BINARY);
 
         // Libera recursos
         CMS_ContentInfo_free(decodedSignature);
-        BIO_free(messageBuffer);
-        X509_STORE_free(rootStore);
 
         // Verifica o resultado da verificação
         if (verificationResult == 1)
@@ -676,22 +1417,307 @@ void printStackTrace() {
     }
 
     /**
-     * A função "getNIDInformation" recupera uma informação específica de uma estrutura X509_NAME
-     * usando um NID (Name Identifier) fornecido.
+     * Verifica uma assinatura CMS destacada sobre dados em memória contra um armazenamento já montado.
      *
-     * @param name Um ponteiro para uma estrutura X509_NAME, que representa o nome de uma entidade em um
-     * certificado X.509.
-     * @param nid O parâmetro "nid" representa o "Name Identifier" (Identificador de Nome) e é um valor inteiro
-     * que representa o atributo ou campo específico na estrutura X509_NAME de onde deseja-se recuperar
-     * a informação. Cada atributo na estrutura X509_NAME possui um valor NID único.
+     * @param rootStore O armazenamento com a cadeia de certificados.
+     * @param bytesFromData Os dados assinados.
+     * @param signature A assinatura CMS em DER.
+     * @param certificate O certificado do signatário.
      *
-     * @return um ponteiro para um array de caracteres (string) contendo a informação associada ao
-     * NID (Identificador de Nome) especificado na estrutura X509_NAME fornecida.
+     * @return um objeto Response com o resultado da verificação.
      */
-    char *getNIDInformation(X509_NAME *name, int nid)
+    Response verifyCmsWithStore(X509_STORE *rootStore, ByteArray *bytesFromData, ByteArray *signature, ByteArray *certificate)
     {
-        int index = X509_NAME_get_index_by_NID(name, nid, -1);
-
+        // Cria um novo objeto BIO para o buffer de mensagem
+        BIO *messageBuffer = BIO_new_mem_buf(bytesFromData->data, bytesFromData->len);
+
+        if (messageBuffer == nullptr)
+        {
+            return {
+                false,
+                "Falha ao criar objeto BIO"};
+        }
+
+        Response verificationResponse = verifyCmsContentWithStore(rootStore, messageBuffer, signature, certificate);
+        BIO_free(messageBuffer);
+        return verificationResponse;
+    }
+
+    /**
+     * Decodifica a cadeia de certificados e verifica uma assinatura CMS destacada sobre o conteúdo do BIO.
+     *
+     * @param content O BIO com os dados assinados. Não é liberado pela função.
+     * @param signature Um array de bytes contendo a assinatura a ser verificada.
+     * @param certificate Um array de bytes contendo o certificado usado para assinar os dados.
+     * @param certificateChain A cadeia de certificados.
+     * @param chainSize O número de certificados na cadeia.
+     *
+     * @return um objeto Response com o resultado da verificação.
+     */
+    Response verifyCmsSignatureContent(
+        BIO *content,
+        ByteArray *signature,
+        ByteArray *certificate,
+        ByteArray **certificateChain,
+        size_t chainSize)
+    {
+        getCryptoLibraryContext();
+
+        // Decodifica a cadeia de certificados
+        STACK_OF(X509) *chainCertificates = sk_X509_new_null();
+        if (chainCertificates == nullptr)
+        {
+            return {
+                false,
+                "Falha ao criar objeto X509_STORE"};
+        }
+        if (!addCertificatesToStack(certificateChain, chainSize, chainCertificates))
+        {
+            sk_X509_pop_free(chainCertificates, X509_free);
+            return {
+                false,
+                "Falha ao adicionar cadeia de certificados ao X509_STORE"};
+        }
+
+        // Cria um novo objeto X509_STORE com a cadeia
+        X509_STORE *rootStore = createStoreFromCertificates(chainCertificates);
+        sk_X509_pop_free(chainCertificates, X509_free);
+        if (rootStore == nullptr)
+        {
+            return {
+                false,
+                "Falha ao criar objeto X509_STORE"};
+        }
+
+        Response verificationResponse = verifyCmsContentWithStore(rootStore, content, signature, certificate);
+        X509_STORE_free(rootStore);
+        return verificationResponse;
+    }
+
+    /**
+     * Esta função verifica uma assinatura CMS usando uma cadeia de certificados e um buffer de mensagem.
+     *
+     * @param bytesFromData Um array de bytes contendo os dados a serem verificados.
+     * @param signature Um array de bytes contendo a assinatura a ser verificada.
+     * @param certificate Um array de bytes contendo o certificado usado para assinar os dados.
+     * @param certificateChain Um array de ponteiros para ByteArrays representando a cadeia de certificados. O
+     * tamanho do array é dado por chainSize.
+     * @param chainSize O tamanho da cadeia de certificados, que é o número de certificados na cadeia.
+     *
+     * @return um objeto de resposta, que contém um valor booleano indicando se a assinatura é válida
+     * ou não, e uma string de mensagem fornecendo informações adicionais sobre o resultado da verificação.
+     */
+    Response verifyCmsSignature(
+        ByteArray *bytesFromData,
+        ByteArray *signature,
+        ByteArray *certificate,
+        ByteArray **certificateChain,
+        size_t chainSize)
+    {
+        // Cria um novo objeto BIO para o buffer de mensagem
+        BIO *messageBuffer = BIO_new_mem_buf(bytesFromData->data, bytesFromData->len);
+
+        if (messageBuffer == nullptr)
+        {
+            return {
+                false,
+                "Falha ao criar objeto BIO"};
+        }
+
+        Response verificationResponse = verifyCmsSignatureContent(messageBuffer, signature, certificate, certificateChain, chainSize);
+        BIO_free(messageBuffer);
+        return verificationResponse;
+    }
+
+    /**
+     * Verifica uma assinatura CMS destacada sobre o conteúdo de um arquivo. O arquivo é lido em blocos
+     * durante o cálculo do resumo, então o uso de memória não depende do tamanho do documento.
+     *
+     * @param filePath O caminho do arquivo assinado.
+     * @param signature Um array de bytes contendo a assinatura a ser verificada.
+     * @param certificate Um array de bytes contendo o certificado usado para assinar os dados.
+     * @param certificateChain A cadeia de certificados.
+     * @param chainSize O número de certificados na cadeia.
+     *
+     * @return um objeto Response com o resultado da verificação.
+     */
+    Response verifyCmsSignatureFile(
+        const char *filePath,
+        ByteArray *signature,
+        ByteArray *certificate,
+        ByteArray **certificateChain,
+        size_t chainSize)
+    {
+        BIO *fileContent = filePath != nullptr ? BIO_new_file(filePath, "rb") : nullptr;
+
+        if (fileContent == nullptr)
+        {
+            return {
+                false,
+                "Falha ao abrir o arquivo assinado"};
+        }
+
+        Response verificationResponse = verifyCmsSignatureContent(fileContent, signature, certificate, certificateChain, chainSize);
+        BIO_free(fileContent);
+        return verificationResponse;
+    }
+
+    /**
+     * Verifica uma assinatura CMS destacada sobre o conteúdo lido de um descritor de arquivo (arquivo,
+     * pipe ou socket), a partir da posição atual até o fim. O descritor não é fechado.
+     *
+     * @param fileDescriptor O descritor com os dados assinados.
+     * @param signature Um array de bytes contendo a assinatura a ser verificada.
+     * @param certificate Um array de bytes contendo o certificado usado para assinar os dados.
+     * @param certificateChain A cadeia de certificados.
+     * @param chainSize O número de certificados na cadeia.
+     *
+     * @return um objeto Response com o resultado da verificação.
+     */
+    Response verifyCmsSignatureFd(
+        int fileDescriptor,
+        ByteArray *signature,
+        ByteArray *certificate,
+        ByteArray **certificateChain,
+        size_t chainSize)
+    {
+        BIO *fdContent = fileDescriptor >= 0 ? BIO_new_fd(fileDescriptor, BIO_NOCLOSE) : nullptr;
+
+        if (fdContent == nullptr)
+        {
+            return {
+                false,
+                "Falha ao criar objeto BIO"};
+        }
+
+        Response verificationResponse = verifyCmsSignatureContent(fdContent, signature, certificate, certificateChain, chainSize);
+        BIO_free(fdContent);
+        return verificationResponse;
+    }
+
+    /**
+     * Verifica um lote de assinaturas CMS destacadas em paralelo. A cadeia de certificados é decodificada
+     * uma única vez; cada thread monta o seu próprio X509_STORE a partir dela (evitando a disputa pela trava
+     * interna do armazenamento) e libera o estado por thread do OpenSSL ao terminar. As threads retiram os
+     * itens de um contador atômico, de modo que documentos de tamanhos diferentes não desbalanceiam o trabalho.
+     *
+     * @param dataList Os dados assinados de cada item.
+     * @param signatureList As assinaturas CMS (DER) de cada item.
+     * @param certificateList Os certificados dos signatários de cada item.
+     * @param itemCount O número de itens nos três arrays.
+     * @param certificateChain A cadeia de certificados compartilhada por todos os itens.
+     * @param chainSize O número de certificados na cadeia.
+     * @param threadCount O número de threads; 0 usa o número de processadores.
+     *
+     * @return um array com itemCount respostas, na mesma ordem dos itens, a ser liberado com freeResponseArray;
+     * ou nullptr se os arrays forem nulos ou a cadeia não puder ser decodificada.
+     */
+    Response *verifyCmsSignatureBatch(
+        ByteArray **dataList,
+        ByteArray **signatureList,
+        ByteArray **certificateList,
+        size_t itemCount,
+        ByteArray **certificateChain,
+        size_t chainSize,
+        int threadCount)
+    {
+        getCryptoLibraryContext();
+
+        if (!dataList || !signatureList || !certificateList || itemCount == 0)
+        {
+            return nullptr;
+        }
+
+        STACK_OF(X509) *chainCertificates = sk_X509_new_null();
+        if (chainCertificates == nullptr || !addCertificatesToStack(certificateChain, chainSize, chainCertificates))
+        {
+            sk_X509_pop_free(chainCertificates, X509_free);
+            return nullptr;
+        }
+
+        if (threadCount <= 0)
+        {
+            threadCount = (int)std::thread::hardware_concurrency();
+        }
+        if (threadCount <= 0)
+        {
+            threadCount = 1;
+        }
+        if ((size_t)threadCount > itemCount)
+        {
+            threadCount = (int)itemCount;
+        }
+
+        Response *results = new Response[itemCount];
+        std::atomic<size_t> nextItem{0};
+        auto worker = [&]()
+        {
+            X509_STORE *rootStore = createStoreFromCertificates(chainCertificates);
+            for (size_t i = nextItem++; i < itemCount; i = nextItem++)
+            {
+                if (rootStore == nullptr)
+                {
+                    results[i] = {false, "Falha ao criar objeto X509_STORE"};
+                }
+                else if (!dataList[i] || !signatureList[i] || !certificateList[i])
+                {
+                    results[i] = {false, "Dados, assinatura ou certificado ausente(s)"};
+                }
+                else
+                {
+                    results[i] = verifyCmsWithStore(rootStore, dataList[i], signatureList[i], certificateList[i]);
+                }
+                ERR_clear_error();
+            }
+            X509_STORE_free(rootStore);
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threadCount; t++)
+        {
+            workers.emplace_back([&worker]()
+                                 {
+                                     worker();
+                                     OPENSSL_thread_stop(); // Libera o estado por thread do OpenSSL
+                                 });
+        }
+        worker(); // A thread chamadora também processa itens
+        for (std::thread &thread : workers)
+        {
+            thread.join();
+        }
+
+        sk_X509_pop_free(chainCertificates, X509_free);
+        return results;
+    }
+
+    /**
+     * Libera um array de respostas retornado por verifyCmsSignatureBatch.
+     *
+     * @param responses O array a ser liberado. Pode ser nulo.
+     */
+    void freeResponseArray(Response *responses)
+    {
+        delete[] responses;
+    }
+
+    /**
+     * A função "getNIDInformation" recupera uma informação específica de uma estrutura X509_NAME
+     * usando um NID (Name Identifier) fornecido.
+     *
+     * @param name Um ponteiro para uma estrutura X509_NAME, que representa o nome de uma entidade em um
+     * certificado X.509.
+     * @param nid O parâmetro "nid" representa o "Name Identifier" (Identificador de Nome) e é um valor inteiro
+     * que representa o atributo ou campo específico na estrutura X509_NAME de onde deseja-se recuperar
+     * a informação. Cada atributo na estrutura X509_NAME possui um valor NID único.
+     *
+     * @return um ponteiro para um array de caracteres (string) contendo a informação associada ao
+     * NID (Identificador de Nome) especificado na estrutura X509_NAME fornecida.
+     */
+    char *getNIDInformation(X509_NAME *name, int nid)
+    {
+        int index = X509_NAME_get_index_by_NID(name, nid, -1);
+
         X509_NAME_ENTRY *entry = X509_NAME_get_entry(name, index);
         ASN1_STRING *asn1 = X509_NAME_ENTRY_get_data(entry);
         auto *string = (char *)ASN1_STRING_get0_data(asn1);
@@ -730,7 +1756,7 @@ void printStackTrace() {
         // Adiciona certificados na stack de CRL
         for (size_t i = 0; i < crlSize; i++)
         {
-            X509_CRL *decodedCrl = decodeCRLs(crls[i]);
+            X509_CRL *decodedCrl = getCachedCRL(crls[i]);
             if (decodedCrl)
             {
                 sk_X509_CRL_push(crlStack, decodedCrl);
@@ -768,11 +1794,8 @@ void printStackTrace() {
                 // Verifica se a CRL tem dominio sobre o certificado alvo.
                 if (revocationCheck == 1)
                 {
-                    X509_REVOKED *revoked_entry = NULL;
-                    int idx = X509_CRL_get0_by_serial(crlFile, &revoked_entry, serial);
-
                     // Checa se o certificado está na lista de revogação.
-                    if (idx == 1 || revoked_entry)
+                    if (lookupRevokedSerial(crlFile, serial, nullptr))
                     {
                         isRevoked = true;
                         break;
@@ -959,10 +1982,10 @@ void printStackTrace() {
      */
     bool verifyCertSignature(X509 *certificate, X509 *issuer)
     {
+        // X509_get0_pubkey não incrementa a referência da chave; X509_verify retorna -1 em caso de erro
+        EVP_PKEY *issuerKey = X509_get0_pubkey(issuer);
 
-        EVP_PKEY *issuerKey = X509_get_pubkey(issuer);
-
-        bool isSigned = X509_verify(certificate, issuerKey);
+        bool isSigned = issuerKey != nullptr && X509_verify(certificate, issuerKey) == 1;
 
         return isSigned;
     }
@@ -997,7 +2020,7 @@ void printStackTrace() {
 
         for (size_t j = 0; j < crlSize; j++)
         {
-            decodedCrl = decodeCRLs(crls[j]);
+            decodedCrl = getCachedCRL(crls[j]);
 
             if (decodedCrl == nullptr)
             {
@@ -1022,205 +2045,424 @@ void printStackTrace() {
         return nullptr;
     }
 
+    static std::atomic<int> currentLogLevel{LOG_ERROR};
+
+    // Define o nível de log (LogLevel); o padrão é LOG_ERROR
+    void setLogLevel(int level)
+    {
+        currentLogLevel.store(level, std::memory_order_relaxed);
+    }
+
     /**
-     * A função getCertificateInformation recupera várias informações de um certificado fornecido,
-     * como os nomes comuns do emissor e do assunto, número de série, período de validade e se o
-     * certificado está expirado ou revogado.
-     *
-     * @param certificate Um ponteiro para um objeto ByteArray que contém os dados do certificado.
-     * @param crls Um array de ponteiros para objetos ByteArray que representam as Listas de Revogação de Certificados (CRLs). Pode ser nulo
-     * @param crlsSize O parâmetro crlsSize representa o tamanho do array crls, que contém
-     * ponteiros para objetos ByteArray representando as Listas de Revogação de Certificados (CRLs). Pode ser nulo.
-     * @param issuerCertificate Um ponteiro para um objeto ByteArray que contém o certificado do emissor.
-     * Esse parâmetro pode ser nullptr se não houver certificado do emissor. Se esse parâmetro for nulo,
-     * não será feita a verificação de revogação do certificado.
+     * Escreve uma mensagem em stderr se o nível dela estiver habilitado. Abaixo do nível atual, o custo
+     * é uma leitura atômica, sem formatação.
      *
-     * @return uma estrutura do tipo CertificateInformation com todas as informações relevantes do certificado.
+     * @param level O nível da mensagem (LogLevel).
+     * @param format O formato, como em printf.
      */
-CertificateInformation getCertificateInformation(
-    ByteArray *certificateData,
-    ByteArray **crlArray,
-    size_t crlCount,
-    ByteArray *issuerCertData)
-{
-    std::cout << "Initializing OpenSSL algorithms...\n";
-    OpenSSL_add_all_algorithms();
-    OpenSSL_add_all_digests();
-    ERR_load_crypto_strings();
-    std::cout << "OpenSSL algorithms initialized.\n";
-
-    std::cout << "Decoding certificate...\n";
-    X509 *certificate = decodeCertificate(certificateData);
-    std::cout << "Certificate decoded.\n";
-
-    X509 *issuerCertificate = nullptr;
-    if (issuerCertData) {
-        std::cout << "Decoding issuer certificate...\n";
-        issuerCertificate = decodeCertificate(issuerCertData);
-        std::cout << "Issuer certificate decoded.\n";
-    }
-
-    CertificateInformation certInfo;
-
-    std::cout << "Initializing CertificateInformation fields...\n";
-    X509_NAME *subjectCN = nullptr;
-    X509_NAME *issuerCN = nullptr;
-    ASN1_TIME *validFrom = nullptr;
-    ASN1_TIME *validTo = nullptr;
-    X509_CRL *decodedCRL = nullptr;
-
-    std::cout << "Checking for available CRLs...\n";
-    decodedCRL = (crlCount > 0) ? getCRLFromCert(crlArray, crlCount, certificate) : nullptr;
-    std::cout << "CRLs check complete.\n";
-
-    std::cout << "Checking if the target certificate is revoked...\n";
-    if (crlArray && issuerCertData) {
-        certInfo.revoked = isCertificateRevokedAdapter(certificate, crlArray, crlCount, issuerCertificate);
-    }
-    std::cout << "Revocation check complete.\n";
-
-    std::cout << "Checking if the certificate signature is valid...\n";
-    if (certificate && issuerCertData) {
-        certInfo.signatureIsValid = verifyCertSignature(certificate, issuerCertificate);
-    }
-    std::cout << "Signature validity check complete.\n";
-
-    char *indeterminadoString = "Indeterminado";
-
-    std::cout << "Retrieving certificate details...\n";
-if (certificate) {
-    printf("Getting subject name...\n");
-    X509_NAME *subjectName = X509_get_subject_name(certificate);
-    
-    printf("Getting issuer name...\n");
-    X509_NAME *issuerName = X509_get_issuer_name(certificate);
-    
-    printf("Getting notBefore time...\n");
-    ASN1_TIME *validFrom = X509_getm_notBefore(certificate);
-    
-    printf("Getting notAfter time...\n");
-    ASN1_TIME *validTo = X509_getm_notAfter(certificate);
-
-    printf("Getting issuer common name...\n");
-    certInfo.issuerCN = issuerName ? getNIDInformation(issuerName, NID_commonName) : indeterminadoString;
-    
-    printf("Getting subject common name...\n");
-    certInfo.subjectCN = subjectName ? getNIDInformation(subjectName, NID_commonName) : indeterminadoString;
-    
-    printf("Getting serial number...\n");
-    certInfo.serialNumber = certificate ? get_serial_number(certificate) : indeterminadoString;
-    
-    printf("Getting subject country...\n");
-    certInfo.subjectCountry = subjectName ? getNIDInformation(subjectName, NID_countryName) : indeterminadoString;
-    
-    printf("Getting subject organization...\n");
-    certInfo.subjectOrganization = subjectName ? getNIDInformation(subjectName, NID_organizationName) : indeterminadoString;
-    if (subjectName){
-    auto temp = getNIDInformation(subjectName, NID_organizationalUnitName);
-    if (temp){
-    certInfo.subjectOrganizationUnit = temp;
-}}
-    //certInfo.subjectOrganizationUnit = subjectName ? getNIDInformation(subjectName, NID_organizationalUnitName) : indeterminadoString;
-
-    
-    printf("Converting validFrom to string...\n");
-    certInfo.validFrom = validFrom ? asn1_timeToString(validFrom) : indeterminadoString;
-    
-    printf("Converting validTo to string...\n");
-    certInfo.validTo = validTo ? asn1_timeToString(validTo) : indeterminadoString;
-    
-    printf("Checking if certificate is expired...\n");
-    certInfo.expired = (validFrom && validTo) ? isCertificateExpired(validFrom, validTo) : false;
-}
-
-    std::cout << "Certificate details retrieval complete.\n";
-
-    std::cout << "Updating CRL information if available...\n";
-    if (decodedCRL) {
-        const ASN1_TIME *lastUpdate = X509_CRL_get0_lastUpdate(decodedCRL);
-        const ASN1_TIME *nextUpdate = X509_CRL_get0_nextUpdate(decodedCRL);
+    void logMessage(int level, const char *format, ...)
+    {
+        if (level > currentLogLevel.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        va_list arguments;
+        va_start(arguments, format);
+        vfprintf(stderr, format, arguments);
+        va_end(arguments);
+        fputc('\n', stderr);
+    }
 
-        certInfo.lastcrlDateInformation = lastUpdate ? asn1_timeToString(lastUpdate) : indeterminadoString;
-        certInfo.nextcrlDateInformation = nextUpdate ? asn1_timeToString(nextUpdate) : indeterminadoString;
+    // Cria uma arena de strings vazia, a ser liberada com freeStringArena
+    StringArena *createStringArena()
+    {
+        return new StringArena;
+    }
 
-        std::cout << "Freeing CRL memory...\n";
-        X509_CRL_free(decodedCRL);
-        std::cout << "CRL memory freed.\n";
+    // Libera a arena e todas as strings alocadas nela
+    void freeStringArena(StringArena *arena)
+    {
+        delete arena;
     }
 
-    std::cout << "Freeing allocated resources...\n";
-    if (issuerCertificate) {
-        freeX509Certificate(issuerCertificate);
+    // Descarta as strings da arena mantendo o primeiro bloco, para reaproveitá-la entre extrações
+    void resetStringArena(StringArena *arena)
+    {
+        if (arena->blocks.size() > 1)
+        {
+            arena->blocks.resize(1);
+            arena->blockCapacity = 4096;
+        }
+        arena->blockUsed = 0;
     }
-    freeX509Certificate(certificate);
-    std::cout << "Allocated resources freed.\n";
 
-    return certInfo;
-}
     /**
-     * A função getCAIssuer obtém a informação do emissor de certificados de autoridade (CA)
-     * contida em um certificado X.509, quando disponível.
-     *
-     * @param certificate Um ponteiro para um objeto ByteArray que contém os dados do certificado.
+     * Copia "length" bytes para a arena, terminando a cópia com '\0'.
      *
-     * @return uma string que representa o emissor de certificados de autoridade (CA) do certificado,
-     * ou nullptr se a informação não estiver disponível.
+     * @return a cópia, válida até o reset ou a liberação da arena.
      */
-    char *getCAIssuer(ByteArray *certificate)
+    const char *arenaCopy(StringArena *arena, const char *data, size_t length)
     {
-        // Decodifica o certificado X.509
-        X509 *decodedCertificate = decodeCertificate(certificate);
-
-        if (decodedCertificate == nullptr)
+        if (arena->blocks.empty() || arena->blockCapacity - arena->blockUsed < length + 1)
         {
-            return "Extension not found.";
+            size_t capacity = length + 1 > 4096 ? length + 1 : 4096;
+            arena->blocks.emplace_back(new char[capacity]);
+            arena->blockCapacity = capacity;
+            arena->blockUsed = 0;
         }
-        int ext_nid = OBJ_txt2nid("1.3.6.1.5.5.7.1.1");
+        char *copy = arena->blocks.back().get() + arena->blockUsed;
+        memcpy(copy, data, length);
+        copy[length] = '\0';
+        arena->blockUsed += length + 1;
+        return copy;
+    }
 
-        X509_EXTENSION *ext = X509_get_ext(decodedCertificate, X509_get_ext_by_NID(decodedCertificate, ext_nid, -1));
-        if (!ext)
+    // Copia o valor de um atributo de nome para a arena em UTF-8; tipos já em ASCII/UTF-8 são copiados direto
+    const char *arenaCopyNameEntry(StringArena *arena, X509_NAME_ENTRY *entry)
+    {
+        const ASN1_STRING *value = X509_NAME_ENTRY_get_data(entry);
+        int type = ASN1_STRING_type(value);
+        if (type == V_ASN1_UTF8STRING || type == V_ASN1_PRINTABLESTRING || type == V_ASN1_IA5STRING)
         {
-            return "Extension not present in the certificate.";
+            return arenaCopy(arena, (const char *)ASN1_STRING_get0_data(value), ASN1_STRING_length(value));
         }
-
-        ASN1_OCTET_STRING *asn1_str = X509_EXTENSION_get_data(ext);
-
-        if (!asn1_str)
+        unsigned char *utf8 = nullptr;
+        int length = ASN1_STRING_to_UTF8(&utf8, value);
+        if (length < 0)
         {
-            return "Extension data not found.";
+            return nullptr;
         }
-        // Convert ASN.1 octet string to a C string
-        char *asn1_string(reinterpret_cast<char *>(asn1_str->data));
-
-        return asn1_string;
+        const char *copy = arenaCopy(arena, (const char *)utf8, length);
+        OPENSSL_free(utf8);
+        return copy;
     }
 
     /**
-     * A função getCrlUpdateInfoTime recebe um array de CRLs, encontra o horário da última atualização entre eles
-     * e retorna-o como uma string.
+     * Extrai os campos de um certificado em uma única passada: cada nome é percorrido uma vez (o primeiro
+     * valor de cada atributo vence, como em X509_NAME_get_index_by_NID), o serial é convertido para
+     * hexadecimal sem BIGNUM e as datas de validade são convertidas para segundos desde a época.
      *
-     * @param crlList Um ponteiro para um array de ponteiros para objetos ByteArray. Esse array representa uma
-     * lista de CRLs (Listas de Revogação de Certificados).
-     * @param crlListSize O parâmetro crlListSize representa o tamanho do array crlList.
+     * @param certificate O certificado decodificado.
+     * @param arena A arena que recebe as strings extraídas.
+     * @param fields A estrutura a ser preenchida.
      *
-     * @return uma string que representa o horário da última atualização das CRLs
-     * na lista fornecida.
+     * @return true se os campos foram extraídos, false se algum parâmetro for nulo.
      */
-    char *getCrlUpdateInfoTime(ByteArray **crlList, size_t crlListSize)
+    bool extractCertificateFields(X509 *certificate, StringArena *arena, CertificateFields *fields)
+    {
+        if (certificate == nullptr || arena == nullptr || fields == nullptr)
+        {
+            return false;
+        }
+        *fields = CertificateFields();
+
+        const X509_NAME *subject = X509_get_subject_name(certificate);
+        for (int i = 0; i < X509_NAME_entry_count(subject); i++)
+        {
+            X509_NAME_ENTRY *entry = X509_NAME_get_entry(subject, i);
+            const char **target = nullptr;
+            switch (OBJ_obj2nid(X509_NAME_ENTRY_get_object(entry)))
+            {
+            case NID_commonName:
+                target = &fields->subjectCN;
+                break;
+            case NID_countryName:
+                target = &fields->subjectCountry;
+                break;
+            case NID_organizationName:
+                target = &fields->subjectOrganization;
+                break;
+            case NID_organizationalUnitName:
+                target = &fields->subjectOrganizationUnit;
+                break;
+            }
+            if (target != nullptr && *target == nullptr)
+            {
+                *target = arenaCopyNameEntry(arena, entry);
+            }
+        }
+
+        const X509_NAME *issuer = X509_get_issuer_name(certificate);
+        for (int i = 0; i < X509_NAME_entry_count(issuer) && fields->issuerCN == nullptr; i++)
+        {
+            X509_NAME_ENTRY *entry = X509_NAME_get_entry(issuer, i);
+            if (OBJ_obj2nid(X509_NAME_ENTRY_get_object(entry)) == NID_commonName)
+            {
+                fields->issuerCN = arenaCopyNameEntry(arena, entry);
+            }
+        }
+
+        // Hexadecimal dos octetos do serial, sem zeros à esquerda, como BN_bn2hex
+        const ASN1_INTEGER *serial = X509_get0_serialNumber(certificate);
+        const unsigned char *serialBytes = ASN1_STRING_get0_data(serial);
+        int serialLength = ASN1_STRING_length(serial);
+        while (serialLength > 0 && serialBytes[0] == 0)
+        {
+            serialBytes++;
+            serialLength--;
+        }
+        char hex[2 * 64 + 2];
+        size_t hexLength = 0;
+        if (ASN1_STRING_type(serial) == V_ASN1_NEG_INTEGER && serialLength > 0)
+        {
+            hex[hexLength++] = '-';
+        }
+        if (serialLength == 0)
+        {
+            hex[hexLength++] = '0';
+        }
+        static const char digits[] = "0123456789ABCDEF";
+        for (int i = 0; i < serialLength && hexLength + 2 < sizeof(hex); i++)
+        {
+            hex[hexLength++] = digits[serialBytes[i] >> 4];
+            hex[hexLength++] = digits[serialBytes[i] & 0x0f];
+        }
+        fields->serialNumber = arenaCopy(arena, hex, hexLength);
+
+        fields->notBefore = asn1TimeToEpoch(X509_get0_notBefore(certificate));
+        fields->notAfter = asn1TimeToEpoch(X509_get0_notAfter(certificate));
+        int64_t now = time(nullptr);
+        fields->expired = now < fields->notBefore || now > fields->notAfter;
+        return true;
+    }
+
+    /**
+     * Decodifica um certificado (PEM ou DER) e extrai seus campos com extractCertificateFields.
+     *
+     * @param certificateBytes Os bytes do certificado.
+     * @param arena A arena que recebe as strings extraídas.
+     * @param fields A estrutura a ser preenchida.
+     *
+     * @return true se o certificado foi decodificado e os campos extraídos.
+     */
+    bool extractCertificateFieldsFromView(ByteView certificateBytes, StringArena *arena, CertificateFields *fields)
+    {
+        X509 *certificate = decodeCertificateView(certificateBytes);
+        if (certificate == nullptr)
+        {
+            logMessage(LOG_ERROR, "Erro ao decodificar o certificado X509");
+            return false;
+        }
+        bool extracted = extractCertificateFields(certificate, arena, fields);
+        X509_free(certificate);
+        return extracted;
+    }
+
+    // Copia uma string extraída para o heap (new[]), como as demais strings de CertificateInformation
+    char *duplicateField(const char *value)
+    {
+        size_t length = strlen(value);
+        char *copy = new char[length + 1];
+        memcpy(copy, value, length + 1);
+        return copy;
+    }
+
+    // Copia uma string extraída, ou DFT se ela não existir, para o heap (new[])
+    char *duplicateFieldOrDefault(const char *value)
+    {
+        return duplicateField(value ? value : DFT);
+    }
+
+    /**
+     * Preenche os campos de texto de uma CertificateInformation, todos com cópias próprias (new[]), de
+     * modo que freeCertificateInformation possa liberá-los sem distinguir valores padrão.
+     *
+     * @param info A estrutura a ser preenchida.
+     * @param fields Os campos extraídos do certificado. Pode ser nulo.
+     * @param revoked O estado de revogação (literal). Pode ser nulo.
+     * @param validFrom, validTo, lastUpdate, nextUpdate Datas já alocadas com new[] (asn1_timeToString), cuja
+     * posse passa para info. Podem ser nulas.
+     */
+    void fillCertificateInformation(CertificateInformation *info, const CertificateFields *fields, const char *revoked,
+                                    char *validFrom, char *validTo, char *lastUpdate, char *nextUpdate)
+    {
+        info->issuerCN = duplicateFieldOrDefault(fields ? fields->issuerCN : nullptr);
+        info->subjectCN = duplicateFieldOrDefault(fields ? fields->subjectCN : nullptr);
+        info->subjectCountry = duplicateFieldOrDefault(fields ? fields->subjectCountry : nullptr);
+        info->subjectOrganization = duplicateFieldOrDefault(fields ? fields->subjectOrganization : nullptr);
+        info->subjectOrganizationUnit = duplicateFieldOrDefault(fields ? fields->subjectOrganizationUnit : nullptr);
+        info->serialNumber = duplicateFieldOrDefault(fields ? fields->serialNumber : nullptr);
+        info->revoked = duplicateFieldOrDefault(revoked);
+        info->validFrom = validFrom ? validFrom : duplicateField(DFT);
+        info->validTo = validTo ? validTo : duplicateField(DFT);
+        info->lastcrlDateInformation = lastUpdate ? lastUpdate : duplicateField(DFT);
+        info->nextcrlDateInformation = nextUpdate ? nextUpdate : duplicateField(DFT);
+    }
+
+    /**
+     * A função getCertificateInformation recupera várias informações de um certificado fornecido,
+     * como os nomes comuns do emissor e do assunto, número de série, período de validade e se o
+     * certificado está expirado ou revogado. Os campos são extraídos com extractCertificateFields e
+     * copiados, de modo que não apontam para a memória do certificado já liberado. Todas as strings,
+     * inclusive as que ficam com o valor padrão, pertencem ao chamador e devem ser liberadas com
+     * freeCertificateInformation.
+     *
+     * @param certificate Um ponteiro para um objeto ByteArray que contém os dados do certificado.
+     * @param crls Um array de ponteiros para objetos ByteArray que representam as Listas de Revogação de Certificados (CRLs). Pode ser nulo
+     * @param crlsSize O parâmetro crlsSize representa o tamanho do array crls, que contém
+     * ponteiros para objetos ByteArray representando as Listas de Revogação de Certificados (CRLs). Pode ser nulo.
+     * @param issuerCertificate Um ponteiro para um objeto ByteArray que contém o certificado do emissor.
+     * Esse parâmetro pode ser nullptr se não houver certificado do emissor. Se esse parâmetro for nulo,
+     * não será feita a verificação de revogação do certificado.
+     *
+     * @return uma estrutura do tipo CertificateInformation com todas as informações relevantes do certificado.
+     */
+    CertificateInformation getCertificateInformation(
+        ByteArray *certificateData,
+        ByteArray **crlArray,
+        size_t crlCount,
+        ByteArray *issuerCertData)
+    {
+        getCryptoLibraryContext();
+
+        CertificateInformation certInfo;
+
+        logMessage(LOG_DEBUG, "Decodificando o certificado");
+        X509 *certificate = decodeCertificate(certificateData);
+        if (certificate == nullptr)
+        {
+            logMessage(LOG_ERROR, "Erro ao decodificar o certificado X509");
+            fillCertificateInformation(&certInfo, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+            return certInfo;
+        }
+
+        X509 *issuerCertificate = issuerCertData ? decodeCertificate(issuerCertData) : nullptr;
+
+        logMessage(LOG_DEBUG, "Verificando revogação e assinatura");
+        X509_CRL *decodedCRL = (crlCount > 0) ? getCRLFromCert(crlArray, crlCount, certificate) : nullptr;
+        const char *revoked = nullptr;
+        if (crlArray && issuerCertificate)
+        {
+            revoked = isCertificateRevokedAdapter(certificate, crlArray, crlCount, issuerCertificate);
+        }
+        if (issuerCertificate)
+        {
+            certInfo.signatureIsValid = verifyCertSignature(certificate, issuerCertificate);
+        }
+
+        logMessage(LOG_DEBUG, "Extraindo os campos do certificado");
+        StringArena arena;
+        CertificateFields fields;
+        extractCertificateFields(certificate, &arena, &fields);
+        certInfo.expired = fields.expired;
+
+        char *validFrom = asn1_timeToString(X509_get0_notBefore(certificate));
+        char *validTo = asn1_timeToString(X509_get0_notAfter(certificate));
+        char *lastUpdate = nullptr;
+        char *nextUpdate = nullptr;
+        if (decodedCRL)
+        {
+            const ASN1_TIME *lastUpdateTime = X509_CRL_get0_lastUpdate(decodedCRL);
+            const ASN1_TIME *nextUpdateTime = X509_CRL_get0_nextUpdate(decodedCRL);
+            lastUpdate = lastUpdateTime ? asn1_timeToString(lastUpdateTime) : nullptr;
+            nextUpdate = nextUpdateTime ? asn1_timeToString(nextUpdateTime) : nullptr;
+            X509_CRL_free(decodedCRL);
+        }
+        fillCertificateInformation(&certInfo, &fields, revoked, validFrom, validTo, lastUpdate, nextUpdate);
+
+        if (issuerCertificate)
+        {
+            freeX509Certificate(issuerCertificate);
+        }
+        freeX509Certificate(certificate);
+        logMessage(LOG_DEBUG, "Informações do certificado extraídas");
+
+        return certInfo;
+    }
+
+    /**
+     * Libera as strings de uma CertificateInformation retornada por getCertificateInformation e anula os
+     * ponteiros. Não deve ser usada em estruturas montadas de outra forma, cujos campos podem ser literais.
+     *
+     * @param info A estrutura cujas strings serão liberadas. Pode ser nula.
+     */
+    void freeCertificateInformation(CertificateInformation *info)
+    {
+        if (info == nullptr)
+        {
+            return;
+        }
+        char **strings[] = {&info->issuerCN, &info->subjectCN, &info->subjectCountry, &info->subjectOrganization,
+                            &info->subjectOrganizationUnit, &info->serialNumber, &info->lastcrlDateInformation,
+                            &info->nextcrlDateInformation, &info->validFrom, &info->validTo, &info->revoked};
+        for (char **field : strings)
+        {
+            delete[] *field;
+            *field = nullptr;
+        }
+    }
+    /**
+     * A função getCAIssuer obtém a informação do emissor de certificados de autoridade (CA)
+     * contida em um certificado X.509, quando disponível.
+     *
+     * @param certificate Um ponteiro para um objeto ByteArray que contém os dados do certificado.
+     *
+     * @return uma string que representa o emissor de certificados de autoridade (CA) do certificado,
+     * ou nullptr se a informação não estiver disponível.
+     */
+    char *getCAIssuer(ByteArray *certificate)
+    {
+        // Decodifica o certificado X.509
+        X509 *decodedCertificate = decodeCertificate(certificate);
+
+        if (decodedCertificate == nullptr)
+        {
+            return "Extension not found.";
+        }
+        int ext_nid = OBJ_txt2nid("1.3.6.1.5.5.7.1.1");
+
+        X509_EXTENSION *ext = X509_get_ext(decodedCertificate, X509_get_ext_by_NID(decodedCertificate, ext_nid, -1));
+        if (!ext)
+        {
+            return "Extension not present in the certificate.";
+        }
+
+        ASN1_OCTET_STRING *asn1_str = X509_EXTENSION_get_data(ext);
+
+        if (!asn1_str)
+        {
+            return "Extension data not found.";
+        }
+        // Convert ASN.1 octet string to a C string
+        char *asn1_string(reinterpret_cast<char *>(asn1_str->data));
+
+        return asn1_string;
+    }
+
+    /**
+     * A função getCrlUpdateInfoTime recebe um array de CRLs, encontra o horário da última atualização entre eles
+     * e retorna-o como uma string.
+     *
+     * @param crlList Um ponteiro para um array de ponteiros para objetos ByteArray. Esse array representa uma
+     * lista de CRLs (Listas de Revogação de Certificados).
+     * @param crlListSize O parâmetro crlListSize representa o tamanho do array crlList.
+     *
+     * @return uma string que representa o horário da última atualização das CRLs
+     * na lista fornecida.
+     */
+    char *getCrlUpdateInfoTime(ByteArray **crlList, size_t crlListSize)
     {
         const ASN1_TIME *updateTime = nullptr;
+        X509_CRL *updateCrl = nullptr; // Mantém viva a CRL de onde updateTime foi lido
 
         // Itera sobre a lista de CRLs para encontrar a última data de atualização
         for (size_t i = 0; i < crlListSize; i++)
         {
             ByteArray *crlBytes = crlList[i];
-            X509_CRL *crl = decodeCRLs(crlBytes);
+            X509_CRL *crl = getCachedCRL(crlBytes);
+            if (crl == nullptr)
+            {
+                continue;
+            }
             const ASN1_TIME *newUpdateTime = X509_CRL_get0_lastUpdate(crl);
 
             // Compara as datas de atualização e mantém a mais recente
             if (!updateTime || ASN1_TIME_compare(newUpdateTime, updateTime))
             {
                 updateTime = newUpdateTime;
+                X509_CRL_free(updateCrl);
+                updateCrl = crl;
+                continue;
             }
 
             // Libera a memória da CRL
@@ -1228,7 +2470,8 @@ if (certificate) {
         }
 
         // Converte a data da última atualização para uma string legível
-        char *updateTimeString = asn1_timeToString(updateTime);
+        char *updateTimeString = updateTime ? asn1_timeToString(updateTime) : nullptr;
+        X509_CRL_free(updateCrl);
 
         return updateTimeString;
     }
@@ -1248,23 +2491,32 @@ if (certificate) {
     char *getCrlNextUpdateTime(ByteArray **crlList, size_t crlListSize)
     {
         const ASN1_TIME *updateTime = nullptr;
+        X509_CRL *updateCrl = nullptr; // Mantém viva a CRL de onde updateTime foi lido
 
         for (size_t i = 0; i < crlListSize; i++)
         {
             ByteArray *crlBytes = crlList[i];
-            X509_CRL *crl = decodeCRLs(crlBytes);
+            X509_CRL *crl = getCachedCRL(crlBytes);
+            if (crl == nullptr)
+            {
+                continue;
+            }
             const ASN1_TIME *newUpdateTime = X509_CRL_get0_nextUpdate(crl);
 
             // if (!updateTime || ASN1_TIME_compare(newUpdateTime, updateTime) == -1) //MALWARE?
             if (!updateTime || ASN1_TIME_compare(newUpdateTime, updateTime))
             {
                 updateTime = newUpdateTime;
+                X509_CRL_free(updateCrl);
+                updateCrl = crl;
+                continue;
             }
 
             X509_CRL_free(crl);
         }
 
-        char *updateTimeString = asn1_timeToString(updateTime);
+        char *updateTimeString = updateTime ? asn1_timeToString(updateTime) : nullptr;
+        X509_CRL_free(updateCrl);
 
         return updateTimeString;
     }
@@ -1323,8 +2575,7 @@ if (certificate) {
         X509_STORE_CTX *cert_ctx = nullptr;
         STACK_OF(X509) *certs = nullptr;
 
-        OpenSSL_add_all_algorithms();
-        ERR_load_crypto_strings();
+        getCryptoLibraryContext();
 
         /*instancia store de certificados
          * ignorou-se a possibilidade de falta de memoria
@@ -1643,8 +2894,7 @@ if (certificate) {
         X509_STORE_CTX *cert_ctx = nullptr;
         STACK_OF(X509) *certs = nullptr;
 
-        OpenSSL_add_all_algorithms();
-        ERR_load_crypto_strings();
+        getCryptoLibraryContext();
 
         /*instancia store de certificados
          * ignorou-se a possibilidade de falta de memoria
@@ -1781,114 +3031,706 @@ if (certificate) {
      *
      * @return o número de URLs de distribuição encontradas no certificado X509 fornecido.
      */
-    int numberOfDistributionPoints(ByteArray *cert)
+    int numberOfDistributionPoints(ByteArray *cert)
+    {
+        int numberOfDistributionURLS = 0;
+        int nid = NID_crl_distribution_points;
+        X509 *certificate = decodeCertificate(cert);
+        if (certificate == nullptr)
+        {
+            return -1;
+        }
+        STACK_OF(DIST_POINT) *distributionPoints = (STACK_OF(DIST_POINT) *)X509_get_ext_d2i(certificate, nid, nullptr, NULL);
+        if (distributionPoints != nullptr)
+        {
+            numberOfDistributionURLS = sk_DIST_POINT_num(distributionPoints);
+            sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
+        }
+        X509_free(certificate);
+        return numberOfDistributionURLS;
+    }
+
+    /**
+     * A função getCrlDistribution recebe um certificado como entrada, decodifica-o, recupera os pontos de distribuição de CRL
+     * e retorna um array de URLs.
+     *
+     * @param cert Um ponteiro para um objeto ByteArray que representa um certificado.
+     *
+     * @return um ponteiro para uma estrutura do tipo Links que contém os URLs dos pontos de distribuição de CRL.
+     */
+    Links *getCrlDistribution(ByteArray *cert)
+    {
+        // Verifica se o certificado de entrada é válido
+        if (!cert)
+        {
+            return nullptr;
+        }
+
+        // Decodifica o certificado X.509
+        X509 *certificate = decodeCertificate(cert);
+        if (!certificate)
+        {
+            return nullptr;
+        }
+
+        // Identifica o NID para os pontos de distribuição de CRL
+        int nid = NID_crl_distribution_points;
+
+        // Obtém os pontos de distribuição de CRL do certificado
+        auto distributionPoints = (STACK_OF(DIST_POINT) *)X509_get_ext_d2i(certificate, nid, nullptr, nullptr);
+
+        // Verifica se os pontos de distribuição foram encontrados
+        if (distributionPoints == nullptr)
+        {
+            X509_free(certificate);
+            return nullptr;
+        }
+
+        // Obtém o número de pontos de distribuição
+        int size = sk_DIST_POINT_num(distributionPoints);
+
+        // Verifica se há pontos de distribuição de CRL
+        if (size == 0)
+        {
+            X509_free(certificate);
+            sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
+            return nullptr;
+        }
+
+        // Aloca memória para armazenar os URLs
+        char **urls = new char *[size];
+        int urlIndex = 0;
+
+        // Itera sobre os pontos de distribuição
+        for (int crlIndex = 0; crlIndex < size; crlIndex++)
+        {
+            DIST_POINT *dp = sk_DIST_POINT_value(distributionPoints, crlIndex);
+
+            // Verifica se o ponto de distribuição é válido
+            if (dp == nullptr || dp->distpoint == nullptr)
+            {
+                X509_free(certificate);
+                sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
+                delete[] urls;
+                return nullptr;
+            }
+
+            DIST_POINT_NAME *distpoint = dp->distpoint;
+            int numNames = sk_GENERAL_NAME_num(distpoint->name.fullname);
+
+            // Itera sobre os nomes de distribuição
+            for (int k = 0; k < numNames; k++)
+            {
+                GENERAL_NAME *generalName = sk_GENERAL_NAME_value(distpoint->name.fullname, k);
+
+                // Verifica se o nome é um URL
+                if (generalName != nullptr && generalName->type == GEN_URI && generalName->d.uniformResourceIdentifier != nullptr)
+                {
+                    ASN1_IA5STRING *urlInASN1 = generalName->d.uniformResourceIdentifier;
+                    auto *url = (char *)ASN1_STRING_get0_data(urlInASN1);
+                    urls[urlIndex] = url;
+                    urlIndex++;
+                }
+            }
+        }
+
+        // Libera a memória e retorna os URLs
+        X509_free(certificate);
+        sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
+        auto urlLinks = new Links{urls, urlIndex};
+        return urlLinks;
+    }
+
+    static const uint32_t revocationDbVersion = 1;
+    static const char revocationDbMagic[8] = {'T', 'C', 'C', 'R', 'V', 'D', 'B', '\0'};
+
+    // Ordem dos seriais na base: comprimento (com o bit de sinal) e depois os octetos
+    bool revocationDbSerialLess(const RevocationDbSerial &left, const RevocationDbSerial &right)
+    {
+        if (left.serialLength != right.serialLength)
+        {
+            return left.serialLength < right.serialLength;
+        }
+        return memcmp(left.serial, right.serial, sizeof(left.serial)) < 0;
+    }
+
+    // Calcula o SHA-1 da chave pública de um certificado, a chave das seções da base
+    bool getIssuerKeyHash(X509 *issuer, unsigned char keyHash[20])
+    {
+        unsigned int length = 0;
+        return X509_pubkey_digest(issuer, EVP_sha1(), keyHash, &length) == 1 && length == 20;
+    }
+
+    /**
+     * Compila CRLs em uma base de revogação binária. Cada CRL é verificada contra o certificado do seu
+     * emissor (nome e assinatura) antes de entrar na base; se houver mais de uma CRL do mesmo emissor,
+     * vale a de thisUpdate mais recente. Só CRLs completas são aceitas: CRLs particionadas
+     * (issuingDistributionPoint) ou delta (deltaCRLIndicator) são recusadas, pois substituiriam a seção
+     * do emissor por uma lista parcial. Entradas com motivo removeFromCRL não são incluídas. O arquivo é
+     * escrito em um temporário e renomeado, para que leitores nunca vejam uma base incompleta.
+     *
+     * @param outputPath O caminho da base a ser gerada.
+     * @param crls As CRLs (PEM ou DER).
+     * @param crlCount O número de CRLs.
+     * @param issuerCertificates Os certificados dos emissores das CRLs (PEM ou DER).
+     * @param issuerCount O número de certificados de emissores.
+     *
+     * @return true se a base foi gerada; false se alguma CRL não puder ser decodificada ou verificada, for
+     * particionada ou delta, tiver seriais com mais de 20 octetos, ou se o arquivo não puder ser escrito.
+     */
+    bool compileRevocationDb(const char *outputPath, ByteArray **crls, size_t crlCount, ByteArray **issuerCertificates, size_t issuerCount)
+    {
+        getCryptoLibraryContext();
+
+        std::vector<X509 *> issuers;
+        for (size_t i = 0; i < issuerCount; i++)
+        {
+            X509 *issuer = decodeCertificate(issuerCertificates[i]);
+            if (issuer != nullptr)
+            {
+                issuers.push_back(issuer);
+            }
+        }
+
+        struct CompiledSection
+        {
+            RevocationDbIssuer issuer;
+            std::vector<RevocationDbSerial> serials;
+        };
+        std::vector<CompiledSection> sections;
+        bool compiled = true;
+
+        for (size_t i = 0; compiled && i < crlCount; i++)
+        {
+            X509_CRL *crl = decodeCRLs(crls[i]);
+            if (crl == nullptr)
+            {
+                logMessage(LOG_ERROR, "CRL %zu: falha na decodificação", i);
+                compiled = false;
+                break;
+            }
+
+            // Cada seção substitui a anterior do mesmo emissor, o que só vale para CRLs completas: uma CRL
+            // particionada (IDP) ou delta cobriria apenas parte dos certificados do emissor
+            if (X509_CRL_get_ext_by_NID(crl, NID_issuing_distribution_point, -1) >= 0 ||
+                X509_CRL_get_ext_by_NID(crl, NID_delta_crl, -1) >= 0)
+            {
+                logMessage(LOG_ERROR, "CRL %zu: CRLs particionadas ou delta não são suportadas", i);
+                X509_CRL_free(crl);
+                compiled = false;
+                break;
+            }
+
+            X509 *crlIssuer = nullptr;
+            for (X509 *issuer : issuers)
+            {
+                if (X509_NAME_cmp(X509_get_subject_name(issuer), X509_CRL_get_issuer(crl)) == 0 &&
+                    X509_CRL_verify(crl, X509_get0_pubkey(issuer)) == 1)
+                {
+                    crlIssuer = issuer;
+                    break;
+                }
+            }
+            CompiledSection section = {};
+            if (crlIssuer == nullptr || !getIssuerKeyHash(crlIssuer, section.issuer.issuerKeyHash))
+            {
+                logMessage(LOG_ERROR, "CRL %zu: nenhum emissor fornecido verifica a assinatura", i);
+                X509_CRL_free(crl);
+                compiled = false;
+                break;
+            }
+            section.issuer.thisUpdate = asn1TimeToEpoch(X509_CRL_get0_lastUpdate(crl));
+            section.issuer.nextUpdate = asn1TimeToEpoch(X509_CRL_get0_nextUpdate(crl));
+
+            STACK_OF(X509_REVOKED) *revokedList = X509_CRL_get_REVOKED(crl);
+            for (int j = 0; revokedList && j < sk_X509_REVOKED_num(revokedList); j++)
+            {
+                const X509_REVOKED *revoked = sk_X509_REVOKED_value(revokedList, j);
+                const ASN1_INTEGER *serial = X509_REVOKED_get0_serialNumber(revoked);
+                int reason = getRevocationReason(revoked);
+                if (reason == CRL_REASON_REMOVE_FROM_CRL)
+                {
+                    continue;
+                }
+                size_t length = ASN1_STRING_length(serial);
+                if (length > sizeof(RevocationDbSerial::serial))
+                {
+                    logMessage(LOG_ERROR, "CRL %zu: serial com %zu octetos (máximo 20)", i, length);
+                    compiled = false;
+                    break;
+                }
+                RevocationDbSerial entry = {};
+                memcpy(entry.serial, ASN1_STRING_get0_data(serial), length);
+                entry.serialLength = (uint8_t)(length | (ASN1_STRING_type(serial) == V_ASN1_NEG_INTEGER ? 0x80 : 0));
+                entry.reason = (int8_t)reason;
+                entry.revocationDate = asn1TimeToEpoch(X509_REVOKED_get0_revocationDate(revoked));
+                section.serials.push_back(entry);
+            }
+            X509_CRL_free(crl);
+
+            // Ordena e descarta seriais repetidos (vale a primeira ocorrência)
+            std::stable_sort(section.serials.begin(), section.serials.end(), revocationDbSerialLess);
+            section.serials.erase(std::unique(section.serials.begin(), section.serials.end(),
+                                              [](const RevocationDbSerial &left, const RevocationDbSerial &right)
+                                              { return !revocationDbSerialLess(left, right) && !revocationDbSerialLess(right, left); }),
+                                  section.serials.end());
+
+            bool merged = false;
+            for (CompiledSection &existing : sections)
+            {
+                if (memcmp(existing.issuer.issuerKeyHash, section.issuer.issuerKeyHash, 20) == 0)
+                {
+                    if (section.issuer.thisUpdate > existing.issuer.thisUpdate)
+                    {
+                        existing = std::move(section);
+                    }
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged)
+            {
+                sections.push_back(std::move(section));
+            }
+        }
+        for (X509 *issuer : issuers)
+        {
+            X509_free(issuer);
+        }
+        if (!compiled)
+        {
+            return false;
+        }
+
+        std::sort(sections.begin(), sections.end(), [](const CompiledSection &left, const CompiledSection &right)
+                  { return memcmp(left.issuer.issuerKeyHash, right.issuer.issuerKeyHash, 20) < 0; });
+
+        // Layout: cabeçalho, tabela de emissores, arrays de seriais
+        RevocationDbHeader header = {};
+        memcpy(header.magic, revocationDbMagic, sizeof(header.magic));
+        header.version = revocationDbVersion;
+        header.issuerCount = (uint32_t)sections.size();
+        header.compiledAt = time(nullptr);
+        header.issuersOffset = sizeof(RevocationDbHeader);
+        uint64_t offset = header.issuersOffset + sections.size() * sizeof(RevocationDbIssuer);
+        for (CompiledSection &section : sections)
+        {
+            section.issuer.serialCount = (uint32_t)section.serials.size();
+            section.issuer.serialsOffset = offset;
+            offset += section.serials.size() * sizeof(RevocationDbSerial);
+        }
+        header.fileSize = offset;
+
+        std::string temporaryPath = std::string(outputPath) + ".tmp";
+        FILE *output = fopen(temporaryPath.c_str(), "wb");
+        if (output == nullptr)
+        {
+            logMessage(LOG_ERROR, "Falha ao criar %s", temporaryPath.c_str());
+            return false;
+        }
+        bool written = fwrite(&header, sizeof(header), 1, output) == 1;
+        for (const CompiledSection &section : sections)
+        {
+            written = written && fwrite(&section.issuer, sizeof(RevocationDbIssuer), 1, output) == 1;
+        }
+        for (const CompiledSection &section : sections)
+        {
+            written = written && (section.serials.empty() ||
+                                  fwrite(section.serials.data(), sizeof(RevocationDbSerial), section.serials.size(), output) == section.serials.size());
+        }
+        written = (fclose(output) == 0) && written;
+        if (!written || rename(temporaryPath.c_str(), outputPath) != 0)
+        {
+            logMessage(LOG_ERROR, "Falha ao escrever %s", outputPath);
+            remove(temporaryPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Abre uma base de revogação compilada: mapeia o arquivo e confere cabeçalho, tamanhos e
+     * deslocamentos, sem ler os seriais. Nenhuma estrutura ASN.1 é decodificada.
+     *
+     * @param path O caminho da base.
+     *
+     * @return a base, a ser fechada com closeRevocationDb, ou nullptr se o arquivo não existir ou for inválido.
+     */
+    RevocationDb *openRevocationDb(const char *path)
+    {
+        MappedFile *file = mapFile(path);
+        if (file == nullptr)
+        {
+            logMessage(LOG_ERROR, "Falha ao mapear a base de revogação %s", path ? path : "(nulo)");
+            return nullptr;
+        }
+
+        const unsigned char *base = static_cast<const unsigned char *>(file->address);
+        const RevocationDbHeader *header = reinterpret_cast<const RevocationDbHeader *>(base);
+        bool valid = file->len >= sizeof(RevocationDbHeader) &&
+                     memcmp(header->magic, revocationDbMagic, sizeof(header->magic)) == 0 &&
+                     header->version == revocationDbVersion &&
+                     header->fileSize == file->len &&
+                     header->issuersOffset >= sizeof(RevocationDbHeader) &&
+                     header->issuersOffset % alignof(RevocationDbIssuer) == 0 &&
+                     header->issuersOffset <= file->len &&
+                     header->issuerCount <= (file->len - header->issuersOffset) / sizeof(RevocationDbIssuer);
+        const RevocationDbIssuer *issuers = valid ? reinterpret_cast<const RevocationDbIssuer *>(base + header->issuersOffset) : nullptr;
+        // Os seriais ficam depois da tabela de emissores; nenhuma seção pode sobrepor cabeçalho ou tabela
+        uint64_t issuersEnd = valid ? header->issuersOffset + (uint64_t)header->issuerCount * sizeof(RevocationDbIssuer) : 0;
+        for (uint32_t i = 0; valid && i < header->issuerCount; i++)
+        {
+            valid = issuers[i].serialsOffset % alignof(RevocationDbSerial) == 0 &&
+                    issuers[i].serialsOffset >= issuersEnd &&
+                    issuers[i].serialsOffset <= file->len &&
+                    issuers[i].serialCount <= (file->len - issuers[i].serialsOffset) / sizeof(RevocationDbSerial);
+        }
+        if (!valid)
+        {
+            logMessage(LOG_ERROR, "Base de revogação inválida: %s", path);
+            unmapFile(file);
+            return nullptr;
+        }
+
+        RevocationDb *db = new RevocationDb;
+        db->file = file;
+        db->header = header;
+        db->issuers = issuers;
+        return db;
+    }
+
+    // Fecha uma base aberta com openRevocationDb
+    void closeRevocationDb(RevocationDb *db)
+    {
+        if (db == nullptr)
+        {
+            return;
+        }
+        unmapFile(db->file);
+        delete db;
+    }
+
+    /**
+     * Consulta um serial na seção de um emissor com duas buscas binárias: na tabela de emissores e no
+     * array ordenado de seriais.
+     *
+     * @param db A base aberta.
+     * @param issuerKeyHash O SHA-1 da chave pública do emissor.
+     * @param serial Os octetos do serial (no máximo 20).
+     * @param serialLength O número de octetos.
+     * @param negative true se o serial for negativo.
+     * @param entry Recebe a data e o motivo quando o serial está revogado. Pode ser nulo.
+     *
+     * @return REVOCATION_DB_REVOKED, REVOCATION_DB_NOT_REVOKED ou REVOCATION_DB_UNKNOWN, quando o emissor
+     * não está na base, a CRL compilada já passou da próxima atualização ou o serial é longo demais.
+     */
+    RevocationDbStatus lookupRevocationDbSerial(const RevocationDb *db, const unsigned char issuerKeyHash[20],
+                                                const unsigned char *serial, size_t serialLength, bool negative,
+                                                RevocationEntry *entry)
+    {
+        if (db == nullptr || serialLength > sizeof(RevocationDbSerial::serial))
+        {
+            return REVOCATION_DB_UNKNOWN;
+        }
+
+        const RevocationDbIssuer *issuersEnd = db->issuers + db->header->issuerCount;
+        const RevocationDbIssuer *issuer = std::lower_bound(db->issuers, issuersEnd, issuerKeyHash,
+                                                            [](const RevocationDbIssuer &candidate, const unsigned char *keyHash)
+                                                            { return memcmp(candidate.issuerKeyHash, keyHash, 20) < 0; });
+        if (issuer == issuersEnd || memcmp(issuer->issuerKeyHash, issuerKeyHash, 20) != 0)
+        {
+            return REVOCATION_DB_UNKNOWN;
+        }
+        if (issuer->nextUpdate != 0 && issuer->nextUpdate < time(nullptr))
+        {
+            return REVOCATION_DB_UNKNOWN;
+        }
+
+        RevocationDbSerial key = {};
+        memcpy(key.serial, serial, serialLength);
+        key.serialLength = (uint8_t)(serialLength | (negative ? 0x80 : 0));
+        const RevocationDbSerial *serials = reinterpret_cast<const RevocationDbSerial *>(
+            static_cast<const unsigned char *>(db->file->address) + issuer->serialsOffset);
+        const RevocationDbSerial *serialsEnd = serials + issuer->serialCount;
+        const RevocationDbSerial *found = std::lower_bound(serials, serialsEnd, key, revocationDbSerialLess);
+        if (found == serialsEnd || revocationDbSerialLess(key, *found))
+        {
+            return REVOCATION_DB_NOT_REVOKED;
+        }
+        if (entry)
+        {
+            entry->revocationDate = found->revocationDate;
+            entry->reason = found->reason;
+        }
+        return REVOCATION_DB_REVOKED;
+    }
+
+    /**
+     * Consulta na base se um certificado foi revogado pelo seu emissor.
+     *
+     * @param db A base aberta.
+     * @param certificate O certificado consultado.
+     * @param issuer O certificado do emissor, cuja chave identifica a seção da base.
+     * @param entry Recebe a data e o motivo quando o certificado está revogado. Pode ser nulo.
+     *
+     * @return o resultado da consulta, como em lookupRevocationDbSerial.
+     */
+    RevocationDbStatus checkRevocationDb(const RevocationDb *db, X509 *certificate, X509 *issuer, RevocationEntry *entry)
+    {
+        unsigned char keyHash[20];
+        if (db == nullptr || certificate == nullptr || issuer == nullptr || !getIssuerKeyHash(issuer, keyHash))
+        {
+            return REVOCATION_DB_UNKNOWN;
+        }
+        const ASN1_INTEGER *serial = X509_get0_serialNumber(certificate);
+        return lookupRevocationDbSerial(db, keyHash, ASN1_STRING_get0_data(serial), ASN1_STRING_length(serial),
+                                        ASN1_STRING_type(serial) == V_ASN1_NEG_INTEGER, entry);
+    }
+
+    // Tamanho máximo padrão de um caminho de certificação, incluindo o certificado final e a raiz
+    static const int defaultMaxPathLength = 16;
+
+    // Cria um conjunto de certificados vazio, a ser liberado com freeCertificatePool
+    CertificatePool *createCertificatePool()
+    {
+        return new CertificatePool;
+    }
+
+    // Libera o conjunto e as referências aos certificados
+    void freeCertificatePool(CertificatePool *pool)
+    {
+        if (pool == nullptr)
+        {
+            return;
+        }
+        for (X509 *certificate : pool->certificates)
+        {
+            X509_free(certificate);
+        }
+        delete pool;
+    }
+
+    /**
+     * Adiciona um certificado ao conjunto, indexando-o pelo SKI e pelo hash do nome do titular.
+     * Certificados repetidos (mesmo SHA-256) são ignorados.
+     *
+     * @param pool O conjunto de certificados.
+     * @param certificate O certificado; o conjunto guarda a sua própria referência.
+     *
+     * @return true se o certificado foi adicionado ou já estava no conjunto.
+     */
+    bool addCertificateToPool(CertificatePool *pool, X509 *certificate)
+    {
+        if (pool == nullptr || certificate == nullptr)
+        {
+            return false;
+        }
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLength = 0;
+        if (X509_digest(certificate, getCryptoLibraryContext()->sha256, digest, &digestLength) != 1)
+        {
+            return false;
+        }
+        std::string fingerprint(reinterpret_cast<char *>(digest), digestLength);
+        if (pool->byFingerprint.count(fingerprint) != 0)
+        {
+            return true;
+        }
+
+        size_t position = pool->certificates.size();
+        X509_up_ref(certificate);
+        pool->certificates.push_back(certificate);
+        pool->byFingerprint.emplace(fingerprint, position);
+        const ASN1_OCTET_STRING *subjectKeyId = X509_get0_subject_key_id(certificate);
+        if (subjectKeyId != nullptr)
+        {
+            pool->bySubjectKeyId.emplace(
+                std::string(reinterpret_cast<const char *>(ASN1_STRING_get0_data(subjectKeyId)), ASN1_STRING_length(subjectKeyId)),
+                position);
+        }
+        pool->bySubjectName.emplace(X509_subject_name_hash(certificate), position);
+        return true;
+    }
+
+    /**
+     * Adiciona ao conjunto os certificados de uma lista de ByteArrays (PEM ou DER).
+     *
+     * @return o número de certificados decodificados; os que não puderem ser decodificados são ignorados.
+     */
+    size_t addCertificatesToPool(CertificatePool *pool, ByteArray **certificates, size_t count)
+    {
+        size_t added = 0;
+        for (size_t i = 0; certificates != nullptr && i < count; i++)
+        {
+            X509 *certificate = decodeCertificate(certificates[i]);
+            if (certificate != nullptr && addCertificateToPool(pool, certificate))
+            {
+                added++;
+            }
+            X509_free(certificate);
+        }
+        return added;
+    }
+
+    // Indica se o certificado é autoemitido (titular igual ao emissor), isto é, o fim de um caminho
+    bool isSelfIssued(X509 *certificate)
+    {
+        return (X509_get_extension_flags(certificate) & EXFLAG_SI) != 0;
+    }
+
+    /**
+     * Lista os possíveis emissores de um certificado no conjunto: primeiro pelo identificador de chave da
+     * autoridade (AKI) contra o SKI e, se nenhum servir, pelo hash do nome do emissor contra o do titular.
+     * Cada candidato é confirmado com X509_check_issued (nome, AKI e uso de chave), sem verificar assinaturas.
+     */
+    void findIssuerCandidates(CertificatePool *pool, X509 *certificate, std::vector<X509 *> &candidates)
+    {
+        candidates.clear();
+        const ASN1_OCTET_STRING *authorityKeyId = X509_get0_authority_key_id(certificate);
+        if (authorityKeyId != nullptr)
+        {
+            auto range = pool->bySubjectKeyId.equal_range(
+                std::string(reinterpret_cast<const char *>(ASN1_STRING_get0_data(authorityKeyId)), ASN1_STRING_length(authorityKeyId)));
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                X509 *candidate = pool->certificates[it->second];
+                if (X509_check_issued(candidate, certificate) == X509_V_OK)
+                {
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+        if (candidates.empty())
+        {
+            auto range = pool->bySubjectName.equal_range(X509_issuer_name_hash(certificate));
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                X509 *candidate = pool->certificates[it->second];
+                if (X509_check_issued(candidate, certificate) == X509_V_OK)
+                {
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+    }
+
+    /**
+     * Busca em profundidade a partir do último certificado de "path". Retorna true ao chegar a um
+     * certificado autoemitido; caso contrário, guarda em "longest" o maior caminho parcial encontrado.
+     * Certificados já presentes no caminho são ignorados, o que evita ciclos entre certificados cruzados.
+     */
+    bool extendCertificationPath(CertificatePool *pool, std::vector<X509 *> &path, std::vector<X509 *> &longest, int maxLength)
     {
-        int numberOfDistributionURLS = 0;
-        int nid = NID_crl_distribution_points;
-        X509 *certificate = decodeCertificate(cert);
-        if (certificate == nullptr)
+        X509 *current = path.back();
+        if (isSelfIssued(current))
         {
-            return -1;
+            return true;
         }
-        STACK_OF(DIST_POINT) *distributionPoints = (STACK_OF(DIST_POINT) *)X509_get_ext_d2i(certificate, nid, nullptr, NULL);
-        if (distributionPoints != nullptr)
+        if (path.size() > longest.size())
         {
-            numberOfDistributionURLS = sk_DIST_POINT_num(distributionPoints);
-            sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
+            longest = path;
         }
-        X509_free(certificate);
-        return numberOfDistributionURLS;
+        if ((int)path.size() >= maxLength)
+        {
+            return false;
+        }
+
+        std::vector<X509 *> candidates;
+        findIssuerCandidates(pool, current, candidates);
+        for (X509 *candidate : candidates)
+        {
+            bool inPath = false;
+            for (X509 *member : path)
+            {
+                inPath = inPath || X509_cmp(member, candidate) == 0;
+            }
+            if (inPath)
+            {
+                continue;
+            }
+            path.push_back(candidate);
+            if (extendCertificationPath(pool, path, longest, maxLength))
+            {
+                return true;
+            }
+            path.pop_back();
+        }
+        return false;
     }
 
     /**
-     * A função getCrlDistribution recebe um certificado como entrada, decodifica-o, recupera os pontos de distribuição de CRL
-     * e retorna um array de URLs.
+     * Monta um caminho de certificação ordenado (certificado final, emissores intermediários, raiz) a
+     * partir de um conjunto de candidatos em qualquer ordem. Cada emissor é localizado pelos índices do
+     * conjunto em tempo constante; quando há mais de um candidato (certificados cruzados), os caminhos
+     * alternativos são tentados até chegar a um certificado autoemitido.
      *
-     * @param cert Um ponteiro para um objeto ByteArray que representa um certificado.
+     * @param pool O conjunto de certificados candidatos.
+     * @param endCertificate O certificado final.
+     * @param maxLength O número máximo de certificados no caminho; 0 usa o padrão (16).
+     * @param complete Recebe true se o caminho termina em um certificado autoemitido. Pode ser nulo.
      *
-     * @return um ponteiro para uma estrutura do tipo Links que contém os URLs dos pontos de distribuição de CRL.
+     * @return a pilha ordenada, começando pelo certificado final, a ser liberada com
+     * sk_X509_pop_free(path, X509_free). Sem caminho completo, retorna o maior caminho parcial.
+     * Retorna nullptr se o conjunto ou o certificado forem nulos.
      */
-    Links *getCrlDistribution(ByteArray *cert)
+    STACK_OF(X509) * buildCertificationPath(CertificatePool *pool, X509 *endCertificate, int maxLength, bool *complete)
     {
-        // Verifica se o certificado de entrada é válido
-        if (!cert)
+        if (complete != nullptr)
         {
-            return nullptr;
+            *complete = false;
         }
-
-        // Decodifica o certificado X.509
-        X509 *certificate = decodeCertificate(cert);
-        if (!certificate)
+        if (pool == nullptr || endCertificate == nullptr)
         {
             return nullptr;
         }
-
-        // Identifica o NID para os pontos de distribuição de CRL
-        int nid = NID_crl_distribution_points;
-
-        // Obtém os pontos de distribuição de CRL do certificado
-        auto distributionPoints = (STACK_OF(DIST_POINT) *)X509_get_ext_d2i(certificate, nid, nullptr, nullptr);
-
-        // Verifica se os pontos de distribuição foram encontrados
-        if (distributionPoints == nullptr)
+        if (maxLength <= 0)
         {
-            X509_free(certificate);
-            return nullptr;
+            maxLength = defaultMaxPathLength;
         }
 
-        // Obtém o número de pontos de distribuição
-        int size = sk_DIST_POINT_num(distributionPoints);
-
-        // Verifica se há pontos de distribuição de CRL
-        if (size == 0)
+        std::vector<X509 *> path{endCertificate};
+        std::vector<X509 *> longest;
+        bool found = extendCertificationPath(pool, path, longest, maxLength);
+        if (complete != nullptr)
         {
-            X509_free(certificate);
-            sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
-            return nullptr;
+            *complete = found;
         }
 
-        // Aloca memória para armazenar os URLs
-        char **urls = new char *[size];
-        int urlIndex = 0;
-
-        // Itera sobre os pontos de distribuição
-        for (int crlIndex = 0; crlIndex < size; crlIndex++)
+        STACK_OF(X509) *orderedPath = sk_X509_new_null();
+        for (X509 *certificate : found ? path : longest)
         {
-            DIST_POINT *dp = sk_DIST_POINT_value(distributionPoints, crlIndex);
+            X509_up_ref(certificate);
+            sk_X509_push(orderedPath, certificate);
+        }
+        return orderedPath;
+    }
 
-            // Verifica se o ponto de distribuição é válido
-            if (dp == nullptr || dp->distpoint == nullptr)
+    /**
+     * Escolhe o certificado final de um conjunto: o primeiro que não é autoemitido e não emitiu nenhum
+     * outro certificado do conjunto.
+     *
+     * @return o certificado (referência do conjunto, não deve ser liberada) ou nullptr.
+     */
+    X509 *findEndCertificate(CertificatePool *pool)
+    {
+        std::unordered_map<X509 *, bool> isIssuer;
+        std::vector<X509 *> candidates;
+        for (X509 *certificate : pool->certificates)
+        {
+            findIssuerCandidates(pool, certificate, candidates);
+            for (X509 *issuer : candidates)
             {
-                X509_free(certificate);
-                sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
-                delete[] urls;
-                return nullptr;
+                isIssuer[issuer] = isIssuer[issuer] || issuer != certificate;
             }
-
-            DIST_POINT_NAME *distpoint = dp->distpoint;
-            int numNames = sk_GENERAL_NAME_num(distpoint->name.fullname);
-
-            // Itera sobre os nomes de distribuição
-            for (int k = 0; k < numNames; k++)
+        }
+        for (X509 *certificate : pool->certificates)
+        {
+            if (!isIssuer[certificate] && !isSelfIssued(certificate))
             {
-                GENERAL_NAME *generalName = sk_GENERAL_NAME_value(distpoint->name.fullname, k);
-
-                // Verifica se o nome é um URL
-                if (generalName != nullptr && generalName->type == GEN_URI && generalName->d.uniformResourceIdentifier != nullptr)
-                {
-                    ASN1_IA5STRING *urlInASN1 = generalName->d.uniformResourceIdentifier;
-                    auto *url = (char *)ASN1_STRING_get0_data(urlInASN1);
-                    urls[urlIndex] = url;
-                    urlIndex++;
-                }
+                return certificate;
             }
         }
-
-        // Libera a memória e retorna os URLs
-        X509_free(certificate);
-        sk_DIST_POINT_pop_free(distributionPoints, DIST_POINT_free);
-        auto urlLinks = new Links{urls, urlIndex};
-        return urlLinks;
+        return pool->certificates.empty() ? nullptr : pool->certificates[0];
     }
 
     /**
@@ -1900,46 +3742,54 @@ if (certificate) {
      * @param crlSize O número de Listas de Revogação de Certificados (CRLs) fornecidas como entrada para a função.
      * @param intermediaryCerts Uma pilha de certificados X509 que representa os certificados intermediários na cadeia de certificados.
      *
-     * @return um valor booleano que indica se o certificado final na cadeia foi revogado ou não.
+     * @return um valor booleano que indica se algum certificado da cadeia, do final até o último
+     * intermediário, foi revogado. Os intermediários podem estar em qualquer ordem.
      */
     bool isChainRevoked(X509 *endCertificate, ByteArray **crls, size_t crlSize, STACK_OF(X509) * intermediaryCerts)
     {
-        bool isRevoked = false;
-        X509_CRL *decodedCrl = nullptr;
+        if (endCertificate == nullptr || intermediaryCerts == nullptr)
+        {
+            return false;
+        }
 
-        // Itera sobre os certificados intermediários na pilha
-        for (size_t i = 0; i < sk_X509_num(intermediaryCerts); i++)
+        // Ordena a cadeia: os intermediários podem vir em qualquer ordem
+        CertificatePool *pool = createCertificatePool();
+        for (int i = 0; i < sk_X509_num(intermediaryCerts); i++)
         {
-            X509 *issuerCert = sk_X509_value(intermediaryCerts, i);
+            addCertificateToPool(pool, sk_X509_value(intermediaryCerts, i));
+        }
+        STACK_OF(X509) *path = buildCertificationPath(pool, endCertificate, 0, nullptr);
+        freeCertificatePool(pool);
 
-            // Verifica se o certificado do emissor e o certificado final são válidos
-            if (issuerCert && endCertificate)
-            {
-                // Obtém a chave pública do emissor
-                EVP_PKEY *issuerKey = X509_get_pubkey(issuerCert);
-                ASN1_INTEGER *serial = X509_get_serialNumber(endCertificate);
+        bool isRevoked = false;
+        // Cada certificado é verificado contra a CRL assinada pelo seu emissor no caminho
+        for (int i = 0; !isRevoked && i + 1 < sk_X509_num(path); i++)
+        {
+            X509 *certificate = sk_X509_value(path, i);
+            EVP_PKEY *issuerKey = X509_get0_pubkey(sk_X509_value(path, i + 1));
+            const ASN1_INTEGER *serial = X509_get0_serialNumber(certificate);
 
-                // Itera sobre as Listas de Revogação de Certificados (CRLs)
-                for (size_t j = 0; j < crlSize; j++)
+            // Itera sobre as Listas de Revogação de Certificados (CRLs)
+            for (size_t j = 0; issuerKey && j < crlSize; j++)
+            {
+                X509_CRL *decodedCrl = getCachedCRL(crls[j]);
+                if (decodedCrl == nullptr)
                 {
-                    // Decodifica a CRL
-                    decodedCrl = decodeCRLs(crls[j]);
+                    continue;
+                }
 
-                    // Verifica a revogação usando a chave do emissor
-                    int revocationCheck = X509_CRL_verify(decodedCrl, issuerKey);
+                // Usa a primeira CRL assinada pela chave do emissor
+                if (X509_CRL_verify(decodedCrl, issuerKey) == 1)
+                {
+                    RevocationEntry revocation;
+                    isRevoked = lookupRevokedSerial(decodedCrl, serial, &revocation) && revocation.reason != CRL_REASON_REMOVE_FROM_CRL;
                     X509_CRL_free(decodedCrl);
-
-                    // Se o certificado final estiver revogado, retorna verdadeiro
-                    if (revocationCheck == 1)
-                    {
-                        X509_REVOKED *revoked = nullptr;
-                        return X509_CRL_get0_by_serial(decodedCrl, &revoked, serial) == 1;
-                    }
+                    break;
                 }
-                // Define o certificado do emissor como o certificado final para a próxima iteração
-                endCertificate = issuerCert;
+                X509_CRL_free(decodedCrl);
             }
         }
+        sk_X509_pop_free(path, X509_free);
         return isRevoked;
     }
 
@@ -2048,8 +3898,178 @@ if (certificate) {
         }
     }
 
+    /**
+     * Decodifica os certificados confiáveis (âncoras de confiança) e os adiciona a uma pilha.
+     *
+     * @param trustedCertificates Um array de certificados confiáveis.
+     * @param trustedCertificatesSize O número de certificados confiáveis no array.
+     * @param trustAnchors A pilha que recebe os certificados decodificados.
+     *
+     * @return um objeto Response indicando se todos os certificados foram decodificados.
+     */
+    Response loadTrustAnchors(ByteArray **trustedCertificates, size_t trustedCertificatesSize, STACK_OF(X509) * trustAnchors)
+    {
+        for (size_t y = 0; y < trustedCertificatesSize; y++)
+        {
+            if (trustedCertificates[y] == nullptr || trustedCertificates[y]->data == nullptr || trustedCertificates[y]->len <= 0)
+            {
+                return Response{
+                    false,
+                    "Falha na decodificação do certificado raiz"};
+            }
+
+            X509 *trustedCert = decodeCertificate(trustedCertificates[y]);
+            if (!trustedCert || !sk_X509_push(trustAnchors, trustedCert))
+            {
+                X509_free(trustedCert);
+                return Response{
+                    false,
+                    "Falha na decodificação do certificado raiz"};
+            }
+        }
+        return Response{true, "Certificados confiáveis carregados"};
+    }
+
+    /**
+     * Cria um armazenamento de certificados confiáveis com as âncoras e as CRLs fornecidas. A checagem de
+     * CRL para toda a cadeia só é habilitada quando ao menos uma CRL é adicionada; sem CRLs, a cadeia é
+     * verificada sem checagem de revogação.
+     *
+     * @param trustAnchors A pilha de certificados confiáveis já decodificados.
+     * @param crls Um array de CRLs a serem adicionadas ao armazenamento. Pode ser nulo.
+     * @param crlSize O número de CRLs no array.
+     * @param store Recebe o armazenamento criado, ou nullptr em caso de erro.
+     *
+     * @return um objeto Response indicando se o armazenamento foi criado.
+     */
+    Response buildTrustedStore(STACK_OF(X509) * trustAnchors, ByteArray **crls, size_t crlSize, X509_STORE **store)
+    {
+        *store = X509_STORE_new();
+        if (!*store)
+        {
+            return Response{
+                false,
+                "Falha na criação do armazenamento de certificados confiáveis"};
+        }
+
+        // O armazenamento guarda sua própria referência de cada certificado e CRL
+        for (int i = 0; i < sk_X509_num(trustAnchors); i++)
+        {
+            X509_STORE_add_cert(*store, sk_X509_value(trustAnchors, i));
+        }
+
+        size_t crlsAdded = 0;
+        for (size_t i = 0; crls && i < crlSize; i++)
+        {
+            if (crls[i] == nullptr)
+            {
+                continue;
+            }
+            X509_CRL *crl = getCachedCRL(crls[i]);
+            if (!crl || X509_STORE_add_crl(*store, crl) != 1)
+            {
+                X509_CRL_free(crl);
+                X509_STORE_free(*store);
+                *store = nullptr;
+                return Response{
+                    false,
+                    "Falha ao adicionar CRL ao armazenamento de certificados confiáveis"};
+            }
+            X509_CRL_free(crl);
+            crlsAdded++;
+        }
+
+        // Define as flags para verificar CRLs apenas se houver alguma; caso contrário toda cadeia
+        // seria rejeitada por falta de CRL
+        if (crlsAdded > 0)
+        {
+            X509_STORE_set_flags(*store, X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
+        }
+        return Response{true, "Armazenamento de certificados confiáveis criado"};
+    }
+
+    /**
+     * Verifica um certificado final e seus intermediários contra um armazenamento já pronto. Apenas o
+     * X509_STORE_CTX é criado por chamada; o armazenamento pode ser compartilhado entre threads.
+     *
+     * @param trustedStore O armazenamento de certificados confiáveis e CRLs.
+     * @param endCertificate O certificado final a ser verificado.
+     * @param certificateChain Os certificados intermediários da cadeia.
+     * @param chainSize O número de certificados intermediários.
+     *
+     * @return um objeto Response indicando se a cadeia de certificados é válida.
+     */
+    Response verifyChainAgainstStore(X509_STORE *trustedStore, ByteArray *endCertificate, ByteArray **certificateChain, size_t chainSize)
+    {
+        // Decodifica o certificado final
+        X509 *targetX509Cert = decodeCertificate(endCertificate);
+        if (!targetX509Cert)
+        {
+            return Response{
+                false,
+                "Falha na decodificação do certificado final"};
+        }
+
+        // Inicializa a pilha de certificados intermediários
+        STACK_OF(X509) *intermediaryCertsStack = sk_X509_new_null();
+        if (!intermediaryCertsStack)
+        {
+            cleanup(targetX509Cert, intermediaryCertsStack, nullptr, nullptr);
+            return Response{
+                false,
+                "Falha na criação da pilha de certificados intermediários"};
+        }
+
+        // Adiciona os certificados intermediários à pilha
+        if (!addCertificatesToStack(certificateChain, chainSize, intermediaryCertsStack))
+        {
+            cleanup(targetX509Cert, intermediaryCertsStack, nullptr, nullptr);
+            return Response{
+                false,
+                "Falha na adição de certificados intermediários à pilha"};
+        }
+
+        X509_STORE_CTX *certVerificationStructure = X509_STORE_CTX_new();
+        if (!certVerificationStructure)
+        {
+            cleanup(targetX509Cert, intermediaryCertsStack, nullptr, certVerificationStructure);
+            return Response{
+                false,
+                "Falha na inicialização da estrutura de verificação de certificados"};
+        }
+
+        // Inicializa a estrutura de verificação de certificados
+        X509_STORE_CTX_init(certVerificationStructure, trustedStore, targetX509Cert, intermediaryCertsStack);
+
+        int verifyResult = X509_verify_cert(certVerificationStructure);
+        Response verificationResponse;
+
+        if (verifyResult == 1)
+        {
+            verificationResponse.isValid = true;
+            verificationResponse.response = "Cadeia de certificados válida";
+        }
+        else if (verifyResult == 0)
+        {
+            verificationResponse.isValid = false;
+            verificationResponse.response = identifyCause(X509_STORE_CTX_get_error(certVerificationStructure));
+        }
+        else // verifyResult <  0
+        {
+            verificationResponse.isValid = false;
+            verificationResponse.response = "Falha ao verificar a cadeia";
+        }
+
+        // O armazenamento pertence ao chamador e não é liberado aqui
+        cleanup(targetX509Cert, intermediaryCertsStack, nullptr, certVerificationStructure);
+
+        return verificationResponse;
+    }
+
     /**
      * A função verifyCertificateChain verifica a validade de uma cadeia de certificados usando a biblioteca OpenSSL em C++.
+     * Para verificar muitas cadeias contra as mesmas âncoras e CRLs, prefira createVerificationContext e
+     * verifyCertificateChainWithContext, que não reconstroem o armazenamento a cada chamada.
      *
      * @param endCertificate Um ponteiro para um objeto ByteArray que representa o certificado final a ser verificado.
      * @param certificateChain Um array de ponteiros para objetos ByteArray que representam os certificados intermediários na cadeia de certificados.
@@ -2070,134 +4090,173 @@ if (certificate) {
         ByteArray **trustedCertificates,
         size_t trustedCertificatesSize)
     {
-        OpenSSL_add_all_algorithms();
-        ERR_load_crypto_strings();
-
-        X509 *targetX509Cert = nullptr;
-        STACK_OF(X509) *intermediaryCertsStack = nullptr;
-        X509_STORE *trustedStore = nullptr;
-        X509_STORE_CTX *certVerificationStructure = nullptr;
-
-        // Verifica a presença de dados de entrada válidos
-        if (!endCertificate || !certificateChain || !trustedCertificates || chainSize == 0)
-        {
-            return Response{
-                false,
-                "Certificado ou cadeia de certificados ausente(s)"};
-        }
-
-        // Decodifica o certificado final
-        targetX509Cert = decodeCertificate(endCertificate);
-
-        if (!targetX509Cert)
-        {
-            return Response{
-                false,
-                "Falha na decodificação do certificado final"};
-        }
+        getCryptoLibraryContext();
 
-        // Inicializa a pilha de certificados intermediários
-        intermediaryCertsStack = sk_X509_new_null();
-        if (!intermediaryCertsStack)
+        // Verifica a presença de dados de entrada válidos
+        if (!endCertificate || !certificateChain || !trustedCertificates || chainSize == 0)
         {
-            cleanup(targetX509Cert, intermediaryCertsStack, trustedStore, certVerificationStructure);
             return Response{
                 false,
-                "Falha na criação da pilha de certificados intermediários"};
+                "Certificado ou cadeia de certificados ausente(s)"};
         }
 
-        // Adiciona os certificados intermediários à pilha
-        if (!addCertificatesToStack(certificateChain, chainSize, intermediaryCertsStack))
+        STACK_OF(X509) *trustAnchors = sk_X509_new_null();
+        if (!trustAnchors)
         {
-            cleanup(targetX509Cert, intermediaryCertsStack, trustedStore, certVerificationStructure);
             return Response{
                 false,
-                "Falha na adição de certificados intermediários à pilha"};
+                "Falha na criação do armazenamento de certificados confiáveis"};
         }
 
-        // Cria o armazenamento de certificados confiáveis
-        trustedStore = X509_STORE_new();
-        if (!trustedStore)
+        X509_STORE *trustedStore = nullptr;
+        Response status = loadTrustAnchors(trustedCertificates, trustedCertificatesSize, trustAnchors);
+        if (status.isValid)
         {
-            cleanup(targetX509Cert, intermediaryCertsStack, trustedStore, certVerificationStructure);
-            return Response{
-                false,
-                "Falha na criação do armazenamento de certificados confiáveis"};
+            status = buildTrustedStore(trustAnchors, crlsCertificates, crlSize, &trustedStore);
         }
-
-        X509 *trustedCert = nullptr;
-
-        // Decodifica e adiciona certificados confiáveis ao armazenamento
-        for (size_t y = 0; y < trustedCertificatesSize; y++)
+        sk_X509_pop_free(trustAnchors, X509_free);
+        if (!status.isValid)
         {
-            if (trustedCertificates[y] == nullptr || trustedCertificates[y]->data == nullptr || trustedCertificates[y]->len <= 0)
-            {
-                cleanup(targetX509Cert, intermediaryCertsStack, trustedStore, certVerificationStructure);
-                return Response{
-                    false,
-                    "Falha na decodificação do certificado raiz"};
-            }
+            return status;
+        }
 
-            trustedCert = decodeCertificate(trustedCertificates[y]);
+        Response verificationResponse = verifyChainAgainstStore(trustedStore, endCertificate, certificateChain, chainSize);
+        X509_STORE_free(trustedStore);
+        return verificationResponse;
+    }
 
-            if (!trustedCert)
-            {
-                cleanup(targetX509Cert, intermediaryCertsStack, trustedStore, certVerificationStructure);
-                return Response{
-                    false,
-                    "Falha na decodificação do certificado raiz"};
-            }
+    /**
+     * Cria um contexto de verificação reutilizável. As âncoras de confiança e as CRLs são decodificadas uma
+     * única vez; cada verificação posterior cria apenas o seu X509_STORE_CTX. O contexto pode ser usado
+     * por várias threads ao mesmo tempo.
+     *
+     * @param trustedCertificates Um array de certificados confiáveis (âncoras de confiança).
+     * @param trustedCertificatesSize O número de certificados confiáveis no array.
+     * @param crls Um array de CRLs usadas na checagem de revogação. Pode ser nulo.
+     * @param crlSize O número de CRLs no array.
+     *
+     * @return um ponteiro para o contexto criado, ou nullptr em caso de erro. Deve ser liberado com freeVerificationContext.
+     */
+    VerificationContext *createVerificationContext(
+        ByteArray **trustedCertificates,
+        size_t trustedCertificatesSize,
+        ByteArray **crls,
+        size_t crlSize)
+    {
+        getCryptoLibraryContext();
 
-            X509_STORE_add_cert(trustedStore, trustedCert);
+        if (!trustedCertificates || trustedCertificatesSize == 0)
+        {
+            fprintf(stderr, "Nenhum certificado confiável fornecido\n");
+            return nullptr;
         }
 
-        // Define as flags para verificar CRLs
-        X509_STORE_set_flags(trustedStore, X509_V_FLAG_CRL_CHECK | X509_V_FLAG_CRL_CHECK_ALL);
-
-        // Adiciona CRLs ao armazenamento
-        if (crlSize > 0)
+        VerificationContext *context = new VerificationContext;
+        context->trustAnchors = sk_X509_new_null();
+        Response status = context->trustAnchors
+                              ? loadTrustAnchors(trustedCertificates, trustedCertificatesSize, context->trustAnchors)
+                              : Response{false, "Falha na criação da pilha de certificados confiáveis"};
+        if (status.isValid)
         {
-            addCrlsToStore(crlsCertificates, crlSize, trustedStore);
+            status = buildTrustedStore(context->trustAnchors, crls, crlSize, &context->store);
         }
-
-        certVerificationStructure = X509_STORE_CTX_new();
-
-        if (!certVerificationStructure)
+        if (!status.isValid)
         {
-            cleanup(targetX509Cert, intermediaryCertsStack, trustedStore, certVerificationStructure);
-            return Response{
-                false,
-                "Falha na inicialização da estrutura de verificação de certificados"};
+            fprintf(stderr, "%s\n", status.response);
+            sk_X509_pop_free(context->trustAnchors, X509_free);
+            delete context;
+            return nullptr;
         }
+        return context;
+    }
 
-        // Inicializa a estrutura de verificação de certificados
-        X509_STORE_CTX_init(certVerificationStructure, trustedStore, targetX509Cert, intermediaryCertsStack);
-
-        int verifyResult = X509_verify_cert(certVerificationStructure);
-        Response verificationResponse;
+    /**
+     * Substitui as CRLs de um contexto de verificação. Um novo armazenamento é montado com as âncoras já
+     * decodificadas e trocado atomicamente; verificações em andamento terminam com o armazenamento anterior.
+     *
+     * @param context O contexto de verificação.
+     * @param crls O novo conjunto de CRLs. Um conjunto vazio desabilita a checagem de revogação.
+     * @param crlSize O número de CRLs no array.
+     *
+     * @return true se as CRLs foram substituídas; em caso de erro o contexto mantém as CRLs anteriores.
+     */
+    bool refreshVerificationContextCrls(VerificationContext *context, ByteArray **crls, size_t crlSize)
+    {
+        if (!context)
+        {
+            return false;
+        }
 
-        if (verifyResult == 1)
+        X509_STORE *newStore = nullptr;
+        Response status = buildTrustedStore(context->trustAnchors, crls, crlSize, &newStore);
+        if (!status.isValid)
         {
-            verificationResponse.isValid = true;
-            verificationResponse.response = "Cadeia de certificados válida";
+            fprintf(stderr, "%s\n", status.response);
+            return false;
         }
-        else if (verifyResult == 0)
+
+        X509_STORE *oldStore = nullptr;
         {
-            verificationResponse.isValid = false;
-            verificationResponse.response = identifyCause(X509_STORE_CTX_get_error(certVerificationStructure));
+            std::lock_guard<std::mutex> lock(context->storeMutex);
+            oldStore = context->store;
+            context->store = newStore;
         }
-        else // verifyResult <  0
+        X509_STORE_free(oldStore);
+        return true;
+    }
+
+    /**
+     * Verifica uma cadeia de certificados usando um contexto de verificação criado por createVerificationContext.
+     *
+     * @param context O contexto de verificação compartilhado.
+     * @param endCertificate O certificado final a ser verificado.
+     * @param certificateChain Os certificados intermediários da cadeia.
+     * @param chainSize O número de certificados intermediários.
+     *
+     * @return um objeto Response indicando se a cadeia de certificados é válida.
+     */
+    Response verifyCertificateChainWithContext(
+        VerificationContext *context,
+        ByteArray *endCertificate,
+        ByteArray **certificateChain,
+        size_t chainSize)
+    {
+        if (!context || !endCertificate || !certificateChain || chainSize == 0)
         {
-            verificationResponse.isValid = false;
-            verificationResponse.response = "Falha ao verificar a cadeia";
+            return Response{
+                false,
+                "Certificado ou cadeia de certificados ausente(s)"};
         }
 
-        // Libera memória e retorna a resposta de verificação
-        cleanup(targetX509Cert, intermediaryCertsStack, trustedStore, certVerificationStructure);
+        // Segura uma referência ao armazenamento atual, para que uma troca de CRLs concorrente não o libere
+        X509_STORE *trustedStore = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(context->storeMutex);
+            trustedStore = context->store;
+            X509_STORE_up_ref(trustedStore);
+        }
 
+        Response verificationResponse = verifyChainAgainstStore(trustedStore, endCertificate, certificateChain, chainSize);
+        X509_STORE_free(trustedStore);
         return verificationResponse;
     }
 
+    /**
+     * Libera um contexto de verificação. Nenhuma verificação pode estar usando o contexto.
+     *
+     * @param context O contexto a ser liberado. Pode ser nulo.
+     */
+    void freeVerificationContext(VerificationContext *context)
+    {
+        if (!context)
+        {
+            return;
+        }
+        X509_STORE_free(context->store);
+        sk_X509_pop_free(context->trustAnchors, X509_free);
+        delete context;
+    }
+
     /**
      * Decodifica uma cadeia de certificados PKCS7 de um ByteArray.
      *
@@ -2237,94 +4296,137 @@ if (certificate) {
         return p7bChain;
     }
 
+    // Codifica um certificado em DER em um novo ByteArray
+    ByteArray *encodeCertificateDer(X509 *certificate)
+    {
+        unsigned char *der = nullptr;
+        int derLength = i2d_X509(certificate, &der);
+        if (derLength <= 0)
+        {
+            return nullptr;
+        }
+        ByteArray *encoded = new ByteArray;
+        encoded->len = derLength;
+        encoded->data = new unsigned char[derLength];
+        memcpy(encoded->data, der, derLength);
+        OPENSSL_free(der);
+        return encoded;
+    }
+
     /**
-     * Decodifica uma cadeia de certificados PKCS7 contida em um ByteArray e extrai os certificados individuais.
+     * Monta o caminho de certificação contido em um P7B: os certificados, em qualquer ordem, formam o
+     * conjunto de candidatos, o certificado final é o que não emitiu nenhum outro e o caminho é montado
+     * com buildCertificationPath.
      *
-     * @param p7bCertificateChain Um ponteiro para o ByteArray que contém a cadeia de certificados PKCS7.
-     *
-     * @return Um ponteiro para um objeto ChainByteArrays que contém os certificados individuais, incluindo o certificado final,
-     *         o certificado intermediário e o certificado raiz, se disponíveis. Retorna nullptr em caso de erro.
+     * @param p7bCertificateChain O P7B (PEM ou DER).
      *
-     * @throws None
+     * @return a pilha ordenada (final, intermediários, raiz), a ser liberada com sk_X509_pop_free(path, X509_free),
+     * ou nullptr se o P7B não puder ser decodificado ou não tiver certificados.
      */
-    ChainByteArrays *decodeCertificateChain(const ByteArray *p7bCertificateChain)
+    STACK_OF(X509) * decodeCertificationPathFromP7B(const ByteArray *p7bCertificateChain)
     {
-        PKCS7 *p7bChain = nullptr;                  // Inicializa o ponteiro p7bChain com a cadeia de certificados PKCS7
-        ChainByteArrays *chainByteArrays = nullptr; // Inicializa o ponteiro chainByteArrays para armazenar os resultados
-        STACK_OF(X509) *certs = nullptr;            // Inicializa o ponteiro certs para armazenar os certificados X509 da cadeia
-        ByteArray *certificate = nullptr;           // Inicializa o ponteiro certificate para representar um certificado X509
-
-        p7bChain = decodeP7B(p7bCertificateChain); // Decodifica o p7bCertificateChain usando a função decodeP7B
-
+        PKCS7 *p7bChain = decodeP7B(p7bCertificateChain);
         if (!p7bChain)
         {
             return nullptr;
         }
 
-        int ObjectIdentifier = OBJ_obj2nid(p7bChain->type); // Obtém o Identificador de Objeto da p7bChain
-
-        // Verifica o Identificador de Objeto (Object Identifier) e define "certs" com base no tipo de certificado PKCS7.
+        STACK_OF(X509) *certs = nullptr;
+        int ObjectIdentifier = OBJ_obj2nid(p7bChain->type);
         if (ObjectIdentifier == NID_pkcs7_signed)
         {
-            certs = p7bChain->d.sign->cert; // Se o Identificador de Objeto for NID_pkcs7_signed, atribui "certs" aos certificados da cadeia.
+            certs = p7bChain->d.sign->cert;
         }
         else if (ObjectIdentifier == NID_pkcs7_signedAndEnveloped)
         {
-            certs = p7bChain->d.signed_and_enveloped->cert; // Se o Identificador de Objeto for NID_pkcs7_signedAndEnveloped, atribui "certs" aos certificados da cadeia.
-        }
-        else
-        {
-            PKCS7_free(p7bChain); // Limpa o objeto PKCS7 se o Identificador de Objeto não for reconhecido
-            return nullptr;
+            certs = p7bChain->d.signed_and_enveloped->cert;
         }
 
-        chainByteArrays = new ChainByteArrays;              // Cria um objeto ChainByteArrays para armazenar os certificados
-        chainByteArrays->endCertificate = nullptr;          // Inicializa o ponteiro endCertificate como nulo
-        chainByteArrays->intermediaryCertificate = nullptr; // Inicializa o ponteiro intermediaryCertificate como nulo
-        chainByteArrays->rootCertificate = nullptr;         // Inicializa o ponteiro rootCertificate como nulo
-        BIO *out;                                           // Inicializa o ponteiro "out" para manipular os dados do certificado
-
+        CertificatePool *pool = createCertificatePool();
         for (int i = 0; certs && i < sk_X509_num(certs); i++)
-        {                                                       // Itera através de cada certificado em "certs"
-            X509 *decodedCertificate = sk_X509_value(certs, i); // Obtém o certificado decodificado de "certs" no índice i
-            out = BIO_new(BIO_s_mem());                         // Cria um novo objeto BIO de memória
+        {
+            addCertificateToPool(pool, sk_X509_value(certs, i));
+        }
+        PKCS7_free(p7bChain); // O conjunto guarda as suas próprias referências
 
-            if (i2d_X509_bio(out, decodedCertificate) == 0)
-            {
-                cleanup(decodedCertificate, nullptr, nullptr, nullptr);
-                BIO_free(out);
-                PKCS7_free(p7bChain);
-                delete chainByteArrays;
-                return nullptr; // Se houver erro na conversão do certificado decodificado para BIO, retorne nullptr
-            }
-            BUF_MEM *bptr;
-            BIO_get_mem_ptr(out, &bptr);
+        X509 *endCertificate = findEndCertificate(pool);
+        STACK_OF(X509) *path = endCertificate ? buildCertificationPath(pool, endCertificate, 0, nullptr) : nullptr;
+        freeCertificatePool(pool);
+        return path;
+    }
 
-            certificate = new ByteArray;                         // Cria um novo objeto ByteArray para representar o certificado
-            certificate->len = bptr->length;                     // Define o comprimento do certificado
-            certificate->data = new unsigned char[bptr->length]; // Aloca memória para os dados do certificado
-            memcpy(certificate->data, bptr->data, bptr->length); // Copia os dados do certificado para o objeto ByteArray
+    /**
+     * Decodifica um P7B e retorna o caminho de certificação ordenado, de qualquer comprimento, em DER.
+     *
+     * @param p7bCertificateChain O P7B (PEM ou DER).
+     * @param pathLength Recebe o número de certificados no caminho.
+     *
+     * @return um array de pathLength ByteArrays (final, intermediários, raiz), a ser liberado com
+     * freeByteArrayList, ou nullptr em caso de erro.
+     */
+    ByteArray **decodeCertificatePath(const ByteArray *p7bCertificateChain, size_t *pathLength)
+    {
+        *pathLength = 0;
+        STACK_OF(X509) *path = decodeCertificationPathFromP7B(p7bCertificateChain);
+        if (path == nullptr)
+        {
+            return nullptr;
+        }
+        ByteArray **encodedPath = new ByteArray *[sk_X509_num(path)];
+        for (int i = 0; i < sk_X509_num(path); i++)
+        {
+            encodedPath[i] = encodeCertificateDer(sk_X509_value(path, i));
+        }
+        *pathLength = sk_X509_num(path);
+        sk_X509_pop_free(path, X509_free);
+        return encodedPath;
+    }
 
-            // Determina a posição do certificado na cadeia com base no índice "i".
-            if (i == 0)
-            {
-                chainByteArrays->endCertificate = certificate; // Se o índice for 0, define endCertificate como o certificado
-            }
-            else if (i == 1)
-            {
-                chainByteArrays->intermediaryCertificate = certificate; // Se o índice for 1, define intermediaryCertificate como o certificado
-            }
-            else if (i == 2)
-            {
-                chainByteArrays->rootCertificate = certificate; // Se o índice for 2, define rootCertificate como o certificado raiz
-            }
+    // Libera um array de ByteArrays retornado por decodeCertificatePath
+    void freeByteArrayList(ByteArray **list, size_t count)
+    {
+        for (size_t i = 0; list != nullptr && i < count; i++)
+        {
+            delete list[i];
+        }
+        delete[] list;
+    }
 
-            BIO_free(out);
-            cleanup(decodedCertificate, nullptr, nullptr, nullptr);
+    /**
+     * Decodifica uma cadeia de certificados PKCS7 contida em um ByteArray e extrai os certificados individuais.
+     * Os certificados podem estar em qualquer ordem no P7B; a cadeia é ordenada com buildCertificationPath.
+     * Para caminhos com mais de um intermediário, use decodeCertificatePath.
+     *
+     * @param p7bCertificateChain Um ponteiro para o ByteArray que contém a cadeia de certificados PKCS7.
+     *
+     * @return Um ponteiro para um objeto ChainByteArrays que contém os certificados individuais, incluindo o certificado final,
+     *         o primeiro certificado intermediário e o certificado raiz (autoemitido), se disponíveis. Retorna nullptr em caso de erro.
+     *
+     * @throws None
+     */
+    ChainByteArrays *decodeCertificateChain(const ByteArray *p7bCertificateChain)
+    {
+        STACK_OF(X509) *path = decodeCertificationPathFromP7B(p7bCertificateChain);
+        if (path == nullptr)
+        {
+            return nullptr;
         }
 
-        PKCS7_free(p7bChain);
+        ChainByteArrays *chainByteArrays = new ChainByteArrays;
+        int pathSize = sk_X509_num(path);
+        chainByteArrays->endCertificate = encodeCertificateDer(sk_X509_value(path, 0));
+        X509 *last = sk_X509_value(path, pathSize - 1);
+        bool hasRoot = pathSize > 1 && isSelfIssued(last);
+        if (hasRoot)
+        {
+            chainByteArrays->rootCertificate = encodeCertificateDer(last);
+        }
+        if (pathSize > (hasRoot ? 2 : 1))
+        {
+            chainByteArrays->intermediaryCertificate = encodeCertificateDer(sk_X509_value(path, 1));
+        }
 
+        sk_X509_pop_free(path, X509_free);
         return chainByteArrays;
     }
 
@@ -2362,12 +4464,12 @@ if (certificate) {
     {
         CrlUpdateInfo crlDateInformation;
         CrlUpdateInfo_Init(&crlDateInformation, NULL, NULL, false, true);
-        X509_CRL *decodedCrl;
+        X509_CRL *decodedCrl = nullptr;
 
         try
         {
 
-            decodedCrl = decodeCRLs(crl);
+            decodedCrl = getCachedCRL(crl);
 
             crlDateInformation.lastUpdate = "Indeterminado";
             crlDateInformation.nextUpdate = "Indeterminado";
@@ -2513,7 +4615,447 @@ ByteArray* createMockCRL() {
     return crlPem;
 }
 
-int main() {
+/**
+ * Gera uma CRL assinada com "entries" seriais revogados aleatórios de 16 octetos, codificada em DER.
+ * Os seriais gerados são devolvidos em "serials" para as consultas do benchmark.
+ */
+ByteArray* createBenchmarkCRL(int entries, std::vector<ASN1_INTEGER*>& serials) {
+    EVP_PKEY* pkey = EVP_RSA_gen(2048);
+    X509_CRL* crl = X509_CRL_new();
+    X509_CRL_set_version(crl, 1);
+    X509_NAME* name = X509_NAME_new();
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"Benchmark CA", -1, -1, 0);
+    X509_CRL_set_issuer_name(crl, name);
+    X509_NAME_free(name);
+    ASN1_TIME* now = ASN1_TIME_adj(nullptr, time(nullptr), 0, 0);
+    ASN1_TIME* next = ASN1_TIME_adj(nullptr, time(nullptr), 7, 0);
+    X509_CRL_set1_lastUpdate(crl, now);
+    X509_CRL_set1_nextUpdate(crl, next);
+
+    ASN1_ENUMERATED* reason = ASN1_ENUMERATED_new();
+    ASN1_ENUMERATED_set(reason, CRL_REASON_KEY_COMPROMISE);
+    unsigned char serialBytes[16];
+    for (int i = 0; i < entries; i++) {
+        RAND_bytes(serialBytes, sizeof(serialBytes));
+        serialBytes[0] &= 0x7f;
+        serialBytes[0] |= 0x01; // Sempre 16 octetos, positivo
+        BIGNUM* bn = BN_bin2bn(serialBytes, sizeof(serialBytes), nullptr);
+        ASN1_INTEGER* serial = BN_to_ASN1_INTEGER(bn, nullptr);
+        BN_free(bn);
+
+        X509_REVOKED* revoked = X509_REVOKED_new();
+        X509_REVOKED_set_serialNumber(revoked, serial);
+        X509_REVOKED_set_revocationDate(revoked, now);
+        if (i % 2 == 0) {
+            X509_REVOKED_add1_ext_i2d(revoked, NID_crl_reason, reason, 0, 0);
+        }
+        X509_CRL_add0_revoked(crl, revoked);
+        serials.push_back(serial);
+    }
+    X509_CRL_sort(crl);
+    X509_CRL_sign(crl, pkey, EVP_sha256());
+
+    unsigned char* der = nullptr;
+    int derLength = i2d_X509_CRL(crl, &der);
+    ByteArray* crlDer = new ByteArray;
+    crlDer->len = derLength;
+    crlDer->data = new unsigned char[derLength];
+    memcpy(crlDer->data, der, derLength);
+
+    OPENSSL_free(der);
+    ASN1_ENUMERATED_free(reason);
+    ASN1_TIME_free(now);
+    ASN1_TIME_free(next);
+    X509_CRL_free(crl);
+    EVP_PKEY_free(pkey);
+    return crlDer;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Benchmark das consultas de revogação: X509_CRL_get0_by_serial contra o índice de seriais revogados,
+ * para CRLs com o número de entradas indicado em cada argumento (padrão: 100000 e 1000000).
+ * Uso: main bench-revocation [entradas...]
+ */
+int runRevocationBenchmark(int argc, char *argv[]) {
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; i++) {
+        sizes.push_back(atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {100000, 1000000};
+    }
+    const int lookups = 1000000;
+    setCrlCacheBudget((size_t)4 << 30);
+
+    for (int entries : sizes) {
+        std::vector<ASN1_INTEGER*> serials;
+        auto start = std::chrono::steady_clock::now();
+        ByteArray* crlDer = createBenchmarkCRL(entries, serials);
+        printf("%d entradas: CRL gerada com %zu bytes em %.0f ms\n", entries, crlDer->len, elapsedMs(start));
+
+        // Consultas: metade seriais revogados, metade seriais ausentes
+        std::vector<ASN1_INTEGER*> queries;
+        unsigned char serialBytes[16];
+        for (int i = 0; i < lookups; i++) {
+            if (i % 2 == 0) {
+                queries.push_back(ASN1_INTEGER_dup(serials[(size_t)rand() % serials.size()]));
+            } else {
+                RAND_bytes(serialBytes, sizeof(serialBytes));
+                serialBytes[0] = (serialBytes[0] & 0x7f) | 0x01;
+                BIGNUM* bn = BN_bin2bn(serialBytes, sizeof(serialBytes), nullptr);
+                queries.push_back(BN_to_ASN1_INTEGER(bn, nullptr));
+                BN_free(bn);
+            }
+        }
+
+        // OpenSSL: a primeira consulta ordena a pilha de X509_REVOKED
+        start = std::chrono::steady_clock::now();
+        X509_CRL* plainCrl = decodeCRLs(crlDer);
+        double decodeMs = elapsedMs(start);
+        X509_REVOKED* revoked = nullptr;
+        start = std::chrono::steady_clock::now();
+        X509_CRL_get0_by_serial(plainCrl, &revoked, queries[0]);
+        double firstLookupMs = elapsedMs(start);
+        int found = 0;
+        start = std::chrono::steady_clock::now();
+        for (ASN1_INTEGER* query : queries) {
+            revoked = nullptr;
+            found += X509_CRL_get0_by_serial(plainCrl, &revoked, query) == 1;
+        }
+        double opensslMs = elapsedMs(start);
+        printf("  X509_CRL_get0_by_serial: decodificação %.0f ms, primeira consulta %.1f ms, %.0f ns/consulta (%d encontrados)\n",
+               decodeMs, firstLookupMs, opensslMs * 1e6 / lookups, found);
+        X509_CRL_free(plainCrl);
+
+        // Índice: montado por getCachedCRL antes de a CRL entrar no cache; a montagem é o tempo de
+        // getCachedCRL menos o de uma decodificação simples (decodeMs)
+        start = std::chrono::steady_clock::now();
+        X509_CRL* cachedCrl = getCachedCRL(crlDer);
+        double cachedMs = elapsedMs(start);
+        double buildMs = cachedMs - decodeMs;
+        found = 0;
+        RevocationEntry entry;
+        start = std::chrono::steady_clock::now();
+        for (ASN1_INTEGER* query : queries) {
+            found += lookupRevokedSerial(cachedCrl, query, &entry);
+        }
+        double indexMs = elapsedMs(start);
+        size_t capacity = 16;
+        while (capacity < (size_t)entries * 2) {
+            capacity *= 2;
+        }
+        printf("  índice de seriais: getCachedCRL %.1f ms (ordenação e montagem ~%.1f ms), %.0f ns/consulta (%d encontrados), %.1f MiB\n",
+               cachedMs, buildMs, indexMs * 1e6 / lookups, found, capacity * sizeof(RevokedSerialEntry) / 1048576.0);
+
+        X509_CRL_free(cachedCrl);
+        clearCrlCache();
+        for (ASN1_INTEGER* serial : serials) {
+            ASN1_INTEGER_free(serial);
+        }
+        for (ASN1_INTEGER* query : queries) {
+            ASN1_INTEGER_free(query);
+        }
+        delete crlDer;
+    }
+    return 0;
+}
+
+/**
+ * Copia o conteúdo de um BIO de memória para um novo ByteArray.
+ */
+ByteArray* byteArrayFromBio(BIO* bio) {
+    BUF_MEM* bptr;
+    BIO_get_mem_ptr(bio, &bptr);
+    ByteArray* bytes = new ByteArray;
+    bytes->len = bptr->length;
+    bytes->data = new unsigned char[bptr->length];
+    memcpy(bytes->data, bptr->data, bptr->length);
+    return bytes;
+}
+
+/**
+ * Benchmark de verifyCmsSignatureBatch: gera um certificado autoassinado e "documentos" assinaturas CMS
+ * destacadas de 4 KiB, e mede a vazão do lote para cada número de threads indicado (padrão: 1, 2, 4 e 8).
+ * Uso: main bench-cms-batch [documentos] [threads...]
+ */
+int runCmsBatchBenchmark(int argc, char *argv[]) {
+    int documents = argc > 2 ? atoi(argv[2]) : 2000;
+    std::vector<int> threadCounts;
+    for (int i = 3; i < argc; i++) {
+        threadCounts.push_back(atoi(argv[i]));
+    }
+    if (threadCounts.empty()) {
+        threadCounts = {1, 2, 4, 8};
+    }
+
+    // Certificado autoassinado do signatário, que também é a cadeia
+    EVP_PKEY* pkey = EVP_RSA_gen(2048);
+    X509* signer = X509_new();
+    X509_set_version(signer, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(signer), 1);
+    X509_gmtime_adj(X509_getm_notBefore(signer), 0);
+    X509_gmtime_adj(X509_getm_notAfter(signer), 31536000L);
+    X509_set_pubkey(signer, pkey);
+    X509_NAME* name = X509_get_subject_name(signer);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"Benchmark Signer", -1, -1, 0);
+    X509_set_issuer_name(signer, name);
+    X509_sign(signer, pkey, EVP_sha256());
+
+    BIO* certBio = BIO_new(BIO_s_mem());
+    i2d_X509_bio(certBio, signer);
+    ByteArray* certificate = byteArrayFromBio(certBio);
+    BIO_free(certBio);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ByteArray*> dataList(documents);
+    std::vector<ByteArray*> signatureList(documents);
+    std::vector<ByteArray*> certificateList(documents, certificate);
+    for (int i = 0; i < documents; i++) {
+        dataList[i] = new ByteArray;
+        dataList[i]->len = 4096;
+        dataList[i]->data = new unsigned char[4096];
+        RAND_bytes(dataList[i]->data, 4096);
+
+        BIO* content = BIO_new_mem_buf(dataList[i]->data, dataList[i]->len);
+        CMS_ContentInfo* cms = CMS_sign(signer, pkey, nullptr, content, CMS_DETACHED | CMS_BINARY | CMS_NOCERTS);
+        BIO* signatureBio = BIO_new(BIO_s_mem());
+        i2d_CMS_bio(signatureBio, cms);
+        signatureList[i] = byteArrayFromBio(signatureBio);
+        BIO_free(signatureBio);
+        CMS_ContentInfo_free(cms);
+        BIO_free(content);
+    }
+    printf("%d documentos de 4 KiB assinados em %.0f ms\n", documents, elapsedMs(start));
+
+    ByteArray* chain[] = {certificate};
+    double baselineMs = 0;
+    for (int threads : threadCounts) {
+        start = std::chrono::steady_clock::now();
+        Response* results = verifyCmsSignatureBatch(dataList.data(), signatureList.data(), certificateList.data(),
+                                                    documents, chain, 1, threads);
+        double batchMs = elapsedMs(start);
+        if (results == nullptr) {
+            fprintf(stderr, "Falha ao verificar o lote\n");
+            break;
+        }
+        int valid = 0;
+        for (int i = 0; i < documents; i++) {
+            valid += results[i].isValid ? 1 : 0;
+        }
+        freeResponseArray(results);
+        if (baselineMs == 0) {
+            baselineMs = batchMs;
+        }
+        printf("  %d thread(s): %.0f ms, %.0f verificações/s, aceleração %.2fx (%d válidas)\n",
+               threads, batchMs, documents * 1000.0 / batchMs, baselineMs / batchMs, valid);
+    }
+    printf("  processadores disponíveis: %u\n", std::thread::hardware_concurrency());
+
+    for (int i = 0; i < documents; i++) {
+        delete dataList[i];
+        delete signatureList[i];
+    }
+    delete certificate;
+    X509_free(signer);
+    EVP_PKEY_free(pkey);
+    return 0;
+}
+
+/**
+ * Benchmark da inicialização: o preâmbulo repetido antes (OpenSSL_add_all_* e ERR_load_crypto_strings)
+ * contra getCryptoLibraryContext, e EVP_Digest de 64 bytes com busca implícita (EVP_sha256) contra o
+ * SHA-256 já buscado.
+ * Uso: main bench-openssl-init [iterações]
+ */
+int runOpenSSLInitBenchmark(int argc, char *argv[]) {
+    int iterations = argc > 2 ? atoi(argv[2]) : 1000000;
+    const CryptoLibraryContext* library = getCryptoLibraryContext();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        OpenSSL_add_all_algorithms();
+        OpenSSL_add_all_ciphers();
+        OpenSSL_add_all_digests();
+        ERR_load_crypto_strings();
+    }
+    double preambleMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        getCryptoLibraryContext();
+    }
+    double contextMs = elapsedMs(start);
+    printf("inicialização: preâmbulo %.1f ns/chamada, contexto %.1f ns/chamada\n",
+           preambleMs * 1e6 / iterations, contextMs * 1e6 / iterations);
+
+    unsigned char input[64] = {0};
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestLength = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        input[0] = (unsigned char)i;
+        EVP_Digest(input, sizeof(input), digest, &digestLength, EVP_sha256(), nullptr);
+    }
+    double implicitMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        input[0] = (unsigned char)i;
+        EVP_Digest(input, sizeof(input), digest, &digestLength, library->sha256, nullptr);
+    }
+    double fetchedMs = elapsedMs(start);
+    printf("SHA-256 de 64 bytes: busca implícita %.1f ns, algoritmo pré-buscado %.1f ns\n",
+           implicitMs * 1e6 / iterations, fetchedMs * 1e6 / iterations);
+    return 0;
+}
+
+/**
+ * Benchmark da extração de campos: getNIDInformation por atributo, get_serial_number e asn1_timeToString
+ * (caminho antigo de getCertificateInformation) contra extractCertificateFields com uma arena reaproveitada.
+ * Uso: main bench-cert-fields [iterações]
+ */
+int runCertificateFieldsBenchmark(int argc, char *argv[]) {
+    int iterations = argc > 2 ? atoi(argv[2]) : 200000;
+
+    EVP_PKEY* pkey = EVP_RSA_gen(2048);
+    X509* x509 = X509_new();
+    X509_set_version(x509, 2);
+    ASN1_INTEGER* serial = s2i_ASN1_INTEGER(nullptr, "0x1F2E3D4C5B6A79880123456789ABCDEF");
+    X509_set_serialNumber(x509, serial);
+    ASN1_INTEGER_free(serial);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 31536000L);
+    X509_set_pubkey(x509, pkey);
+    X509_NAME* name = X509_get_subject_name(x509);
+    X509_NAME_add_entry_by_txt(name, "C", MBSTRING_ASC, (const unsigned char*)"BR", -1, -1, 0);
+    X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC, (const unsigned char*)"ICP-Brasil", -1, -1, 0);
+    X509_NAME_add_entry_by_txt(name, "OU", MBSTRING_ASC, (const unsigned char*)"Autoridade Certificadora", -1, -1, 0);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_UTF8, (const unsigned char*)"João da Silva:12345678901", -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+    X509_sign(x509, pkey, EVP_sha256());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        X509_NAME* subjectName = X509_get_subject_name(x509);
+        X509_NAME* issuerName = X509_get_issuer_name(x509);
+        getNIDInformation(issuerName, NID_commonName);
+        getNIDInformation(subjectName, NID_commonName);
+        getNIDInformation(subjectName, NID_countryName);
+        getNIDInformation(subjectName, NID_organizationName);
+        getNIDInformation(subjectName, NID_organizationalUnitName);
+        char* serialHex = get_serial_number(x509);
+        char* validFrom = asn1_timeToString(X509_get0_notBefore(x509));
+        char* validTo = asn1_timeToString(X509_get0_notAfter(x509));
+        isCertificateExpired(X509_get0_notBefore(x509), X509_get0_notAfter(x509));
+        OPENSSL_free(serialHex);
+        delete[] validFrom;
+        delete[] validTo;
+    }
+    double perFieldMs = elapsedMs(start);
+
+    StringArena* arena = createStringArena();
+    CertificateFields fields;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        resetStringArena(arena);
+        extractCertificateFields(x509, arena, &fields);
+    }
+    double singlePassMs = elapsedMs(start);
+    printf("extração de campos: por atributo %.0f ns/certificado, passada única %.0f ns/certificado\n",
+           perFieldMs * 1e6 / iterations, singlePassMs * 1e6 / iterations);
+    printf("  CN=%s O=%s OU=%s C=%s serial=%s validade=%" PRId64 "..%" PRId64 "\n", fields.subjectCN,
+           fields.subjectOrganization, fields.subjectOrganizationUnit, fields.subjectCountry, fields.serialNumber,
+           fields.notBefore, fields.notAfter);
+
+    freeStringArena(arena);
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+    return 0;
+}
+
+/**
+ * Compila CRLs em uma base de revogação. Os arquivos podem vir em qualquer ordem: cada um é lido como
+ * CRL ou, se não for, como certificado de emissor.
+ * Uso: main compile-crls <base> <crl ou certificado>...
+ */
+int runCompileCrls(int argc, char *argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "Uso: %s compile-crls <base> <crl ou certificado>...\n", argv[0]);
+        return 2;
+    }
+    std::vector<ByteArray*> crls;
+    std::vector<ByteArray*> issuers;
+    for (int i = 3; i < argc; i++) {
+        MappedFile* file = mapFile(argv[i]);
+        ByteView view = mappedFileView(file);
+        X509_CRL* crl = decodeCrlView(view);
+        X509* certificate = crl ? nullptr : decodeCertificateView(view);
+        if (crl || certificate) {
+            ByteArray* bytes = new ByteArray;
+            bytes->len = view.len;
+            bytes->data = new unsigned char[view.len];
+            memcpy(bytes->data, view.data, view.len);
+            (crl ? crls : issuers).push_back(bytes);
+        } else {
+            fprintf(stderr, "%s: não é uma CRL nem um certificado\n", argv[i]);
+        }
+        X509_CRL_free(crl);
+        X509_free(certificate);
+        unmapFile(file);
+        if (!crl && !certificate) {
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool compiled = compileRevocationDb(argv[2], crls.data(), crls.size(), issuers.data(), issuers.size());
+    double compileMs = elapsedMs(start);
+    for (ByteArray* bytes : crls) {
+        delete bytes;
+    }
+    for (ByteArray* bytes : issuers) {
+        delete bytes;
+    }
+    if (!compiled) {
+        return 1;
+    }
+
+    start = std::chrono::steady_clock::now();
+    RevocationDb* db = openRevocationDb(argv[2]);
+    double openMs = elapsedMs(start);
+    if (db == nullptr) {
+        return 1;
+    }
+    uint64_t serials = 0;
+    for (uint32_t i = 0; i < db->header->issuerCount; i++) {
+        serials += db->issuers[i].serialCount;
+    }
+    printf("%s: %u emissor(es), %" PRIu64 " seriais, %zu bytes; compilada em %.0f ms, aberta em %.3f ms\n",
+           argv[2], db->header->issuerCount, serials, db->file->len, compileMs, openMs);
+    closeRevocationDb(db);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "bench-revocation") == 0) {
+        return runRevocationBenchmark(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "bench-cms-batch") == 0) {
+        return runCmsBatchBenchmark(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "bench-openssl-init") == 0) {
+        return runOpenSSLInitBenchmark(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "bench-cert-fields") == 0) {
+        return runCertificateFieldsBenchmark(argc, argv);
+    }
+    if (argc > 1 && strcmp(argv[1], "compile-crls") == 0) {
+        return runCompileCrls(argc, argv);
+    }
     try {
         std::cout << "Starting OpenSSL...\n";
         startOpenSSL();
@@ -2561,6 +5103,20 @@ int main() {
         std::cout << "Serial Number: " << certInfo.serialNumber << "\n";
         std::cout << "Valid From: " << certInfo.validFrom << "\n";
         std::cout << "Valid To: " << certInfo.validTo << "\n";
+        freeCertificateInformation(&certInfo);
+
+        // Testing the reusable verification context
+        std::cout << "Creating verification context...\n";
+        ByteArray* trustedList[] = { certificatePem };
+        VerificationContext* context = createVerificationContext(trustedList, 1, nullptr, 0);
+        if (context != nullptr) {
+            ByteArray* chainList[] = { certificatePem };
+            Response chainResult = verifyCertificateChainWithContext(context, certificatePem, chainList, 1);
+            std::cout << "Chain verification with context: " << chainResult.response << "\n";
+            freeVerificationContext(context);
+        } else {
+            std::cout << "Failed to create verification context.\n";
+        }
 
         // Cleaning up dynamically allocated memory
         std::cout << "Cleaning up dynamically allocated memory...\n";
@@ -0,0 +1,355 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "access_log.h"
+#include "parser.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char binaryMagic[4] = {'B', 'S', 'R', 'L'};
+const uint32_t binaryVersion = 1;
+
+void putU16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xff));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+void putI64(std::string& out, int64_t value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int i = 0; i < 8; i++) {
+        out.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+    }
+}
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+uint64_t getLE(const unsigned char* bytes, int width) {
+    uint64_t value = 0;
+    for (int i = 0; i < width; i++) {
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+std::string formatLocalTime(int64_t timestamp, const char* format) {
+    std::time_t time = static_cast<std::time_t>(timestamp);
+    std::tm tm;
+    localtime_r(&time, &tm);
+    char text[32];
+    size_t len = std::strftime(text, sizeof(text), format, &tm);
+    return std::string(text, len);
+}
+
+class AccessLogWriter {
+public:
+    std::string start(const AccessLogConfig& logConfig) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            return "";
+        }
+        config = logConfig;
+        std::error_code ec;
+        std::string previous = fs::exists(config.path, ec) && fs::file_size(config.path, ec) > 0 ? config.path : "";
+        if (config.binary && !previous.empty()) {
+            // String ids restart per file, so a previous run's binary log is moved aside
+            // before the writer thread exists; callers get the archive's final name.
+            previous = archiveCurrentFile();
+        }
+        running = true;
+        worker = std::thread(&AccessLogWriter::run, this);
+        return previous;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) {
+                return;
+            }
+            running = false;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    void push(AccessLogRecord&& record) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running || pending.size() >= config.maxPending) {
+                dropped++;
+                return;
+            }
+            pending.push_back(std::move(record));
+        }
+        cv.notify_one();
+    }
+
+private:
+    void run() {
+        openFile();
+        std::vector<AccessLogRecord> batch;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait_for(lock, std::chrono::seconds(1), [this] { return !pending.empty() || !running; });
+            batch.swap(pending);
+            bool stopping = !running;
+            uint64_t droppedNow = dropped;
+            dropped = 0;
+            lock.unlock();
+
+            if (droppedNow > 0) {
+                std::cerr << "Error: Access log queue full, dropped " << droppedNow << " records." << std::endl;
+            }
+            for (const AccessLogRecord& record : batch) {
+                writeRecord(record);
+            }
+            batch.clear();
+            flushBuffer();
+            if (config.maxAgeSeconds > 0 && std::time(nullptr) - openedAt >= config.maxAgeSeconds && fileBytes > headerBytes()) {
+                rotate();
+            }
+
+            lock.lock();
+            if (stopping && pending.empty()) {
+                break;
+            }
+        }
+        lock.unlock();
+        file.close();
+    }
+
+    size_t headerBytes() const {
+        return config.binary ? sizeof(binaryMagic) + sizeof(binaryVersion) : 0;
+    }
+
+    void openFile() {
+        std::error_code ec;
+        uintmax_t existing = fs::exists(config.path, ec) ? fs::file_size(config.path, ec) : 0;
+        file.open(config.path, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Error: Unable to open log file." << std::endl;
+        }
+        fileBytes = existing;
+        openedAt = std::time(nullptr);
+        strings.clear();
+        if (config.binary) {
+            buffer.append(binaryMagic, sizeof(binaryMagic));
+            putU32(buffer, binaryVersion);
+        }
+    }
+
+    std::string archiveCurrentFile() {
+        std::string base = config.path + "." + formatLocalTime(std::time(nullptr), "%Y%m%d-%H%M%S");
+        std::string target = base;
+        std::error_code ec;
+        for (int suffix = 1; fs::exists(target, ec); suffix++) {
+            target = base + "-" + std::to_string(suffix);
+        }
+        fs::rename(config.path, target, ec);
+        if (ec) {
+            std::cerr << "Error: Unable to rotate log file: " << ec.message() << std::endl;
+            return "";
+        }
+        return target;
+    }
+
+    void rotate() {
+        flushBuffer();
+        file.close();
+        archiveCurrentFile();
+        openFile();
+    }
+
+    uint32_t internString(const std::string& value) {
+        auto it = strings.find(value);
+        if (it != strings.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        std::string stored = value.size() > 0xffff ? value.substr(0, 0xffff) : value;
+        buffer.push_back('S');
+        putU32(buffer, id);
+        putU16(buffer, static_cast<uint16_t>(stored.size()));
+        buffer += stored;
+        strings.emplace(value, id);
+        return id;
+    }
+
+    void writeRecord(const AccessLogRecord& record) {
+        if (config.maxBytes > 0 && fileBytes + buffer.size() >= config.maxBytes && fileBytes + buffer.size() > headerBytes()) {
+            rotate();
+        }
+        if (config.binary) {
+            uint32_t methodId = internString(record.method);
+            uint32_t resourceId = internString(record.resource);
+            uint32_t ipId = internString(record.ip);
+            buffer.push_back('R');
+            putI64(buffer, record.timestamp);
+            putU16(buffer, record.status);
+            putU32(buffer, methodId);
+            putU32(buffer, resourceId);
+            putU32(buffer, ipId);
+            putVarint(buffer, record.durationMs);
+        } else {
+            buffer += formatAccessLogLine(record);
+            buffer.push_back('\n');
+        }
+    }
+
+    void flushBuffer() {
+        if (buffer.empty()) {
+            return;
+        }
+        if (file.is_open()) {
+            file.write(buffer.data(), buffer.size());
+            file.flush();
+        }
+        fileBytes += buffer.size();
+        buffer.clear();
+    }
+
+    AccessLogConfig config;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<AccessLogRecord> pending;
+    uint64_t dropped = 0;
+    bool running = false;
+    std::thread worker;
+
+    // Owned by the worker thread.
+    std::ofstream file;
+    uint64_t fileBytes = 0;
+    std::time_t openedAt = 0;
+    std::unordered_map<std::string, uint32_t> strings;
+    std::string buffer;
+};
+
+AccessLogWriter accessLogWriter;
+
+} // namespace
+
+AccessLogConfig accessLogConfigFromMap(const std::map<std::string, std::string>& config) {
+    AccessLogConfig logConfig;
+    logConfig.binary = getConfigValue(config, "log_format", "text") == "binary";
+    logConfig.path = getConfigValue(config, "log_file", logConfig.binary ? "server_requests.bin" : "server_requests.log");
+    logConfig.maxBytes = static_cast<uint64_t>(getConfigNumber(config, "log_max_bytes", 0));
+    logConfig.maxAgeSeconds = getConfigNumber(config, "log_max_age", 0);
+    return logConfig;
+}
+
+std::string startAccessLog(const AccessLogConfig& config) {
+    return accessLogWriter.start(config);
+}
+
+void stopAccessLog() {
+    accessLogWriter.stop();
+}
+
+void appendAccessLog(const std::string& method, const std::string& resource, const std::string& status, const std::string& ip, long long duration) {
+    AccessLogRecord record;
+    record.timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    record.method = method;
+    record.resource = resource;
+    for (char c : status) {
+        if (c < '0' || c > '9') {
+            break;
+        }
+        record.status = static_cast<uint16_t>(record.status * 10 + (c - '0'));
+    }
+    record.ip = ip;
+    record.durationMs = duration > 0 ? static_cast<uint64_t>(duration) : 0;
+    accessLogWriter.push(std::move(record));
+}
+
+std::string formatAccessLogLine(const AccessLogRecord& record) {
+    std::string line = "[" + formatLocalTime(record.timestamp, "%Y-%m-%d %H:%M:%S") + "] ";
+    line += record.method + " " + record.resource + " " + std::to_string(record.status) + " " + record.ip + " " + std::to_string(record.durationMs) + "ms";
+    return line;
+}
+
+bool readBinaryAccessLog(const std::string& path, const std::function<void(const AccessLogRecord&)>& onRecord) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open log file: " << path << std::endl;
+        return false;
+    }
+
+    unsigned char header[8];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) || std::string(reinterpret_cast<char*>(header), 4) != std::string(binaryMagic, 4) || getLE(header + 4, 4) != binaryVersion) {
+        std::cerr << "Error: Not a binary access log: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> strings;
+    auto lookup = [&strings](uint64_t id, std::string& out) {
+        if (id >= strings.size()) {
+            return false;
+        }
+        out = strings[id];
+        return true;
+    };
+
+    AccessLogRecord record;
+    int tag;
+    while ((tag = file.get()) != EOF) {
+        if (tag == 'S') {
+            unsigned char fields[6];
+            if (!file.read(reinterpret_cast<char*>(fields), sizeof(fields))) {
+                return false;
+            }
+            uint64_t id = getLE(fields, 4);
+            std::string value(getLE(fields + 4, 2), '\0');
+            if (id != strings.size() || !file.read(&value[0], value.size())) {
+                return false;
+            }
+            strings.push_back(std::move(value));
+        } else if (tag == 'R') {
+            unsigned char fields[22];
+            if (!file.read(reinterpret_cast<char*>(fields), sizeof(fields))) {
+                return false;
+            }
+            record.timestamp = static_cast<int64_t>(getLE(fields, 8));
+            record.status = static_cast<uint16_t>(getLE(fields + 8, 2));
+            if (!lookup(getLE(fields + 10, 4), record.method) || !lookup(getLE(fields + 14, 4), record.resource) || !lookup(getLE(fields + 18, 4), record.ip)) {
+                return false;
+            }
+            record.durationMs = 0;
+            for (int shift = 0;; shift += 7) {
+                int byte = file.get();
+                if (byte == EOF || shift > 63) {
+                    return false;
+                }
+                record.durationMs |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    break;
+                }
+            }
+            onRecord(record);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
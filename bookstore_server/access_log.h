@@ -0,0 +1,49 @@
+#ifndef ACCESS_LOG_H
+#define ACCESS_LOG_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+
+// Binary access log layout (all integers little-endian):
+//   file header  : "BSRL" magic, uint32 version
+//   'S' entry    : uint32 id, uint16 length, bytes       -- string table entry
+//   'R' entry    : int64 epoch seconds, uint16 status,
+//                  uint32 method id, uint32 resource id,
+//                  uint32 ip id, varint duration (ms)    -- one request
+// String ids are assigned per file, so every rotated file decodes on its own.
+
+struct AccessLogRecord {
+    int64_t timestamp = 0;
+    std::string method;
+    std::string resource;
+    uint16_t status = 0;
+    std::string ip;
+    uint64_t durationMs = 0;
+};
+
+struct AccessLogConfig {
+    std::string path = "server_requests.log";
+    bool binary = false;
+    uint64_t maxBytes = 0;       // 0 disables size-based rotation
+    long long maxAgeSeconds = 0; // 0 disables age-based rotation
+    size_t maxPending = 65536;   // records beyond this are dropped instead of blocking requests
+};
+
+AccessLogConfig accessLogConfigFromMap(const std::map<std::string, std::string>& config);
+
+// Starts the background writer; appendAccessLog only enqueues. Returns where the
+// previous run's log can be read from (config.path, or the archive a binary log
+// was moved to before the writer started), or "" when there is none.
+std::string startAccessLog(const AccessLogConfig& config);
+void stopAccessLog();
+void appendAccessLog(const std::string& method, const std::string& resource, const std::string& status, const std::string& ip, long long duration);
+
+// Renders a record exactly as the text log does, without the trailing newline.
+std::string formatAccessLogLine(const AccessLogRecord& record);
+
+// Decodes a binary log, calling onRecord for each request. Returns false on a malformed file.
+bool readBinaryAccessLog(const std::string& path, const std::function<void(const AccessLogRecord&)>& onRecord);
+
+#endif // ACCESS_LOG_H
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include "admission.h"
+#include "parser.h"
+
+AdmissionConfig admissionConfigFromMap(const std::map<std::string, std::string>& config) {
+    AdmissionConfig admission;
+    admission.initialLimit = static_cast<double>(getConfigNumber(config, "max_users", 20));
+    admission.minLimit = static_cast<double>(getConfigNumber(config, "admission_min_limit", 1));
+    admission.maxLimit = static_cast<double>(getConfigNumber(config, "admission_max_limit", static_cast<long long>(admission.initialLimit * 4)));
+    admission.maxQueue = static_cast<int>(getConfigNumber(config, "admission_queue_size", admission.maxQueue));
+    admission.queueTimeout = std::chrono::milliseconds(getConfigNumber(config, "admission_queue_timeout_ms", admission.queueTimeout.count()));
+    admission.latencyTarget = std::chrono::milliseconds(getConfigNumber(config, "admission_latency_target_ms", admission.latencyTarget.count()));
+    return admission;
+}
+
+void AdmissionController::configure(const AdmissionConfig& newConfig) {
+    std::lock_guard<std::mutex> lock(mutex);
+    config = newConfig;
+    config.minLimit = std::max(1.0, config.minLimit);
+    config.maxLimit = std::max(config.minLimit, config.maxLimit);
+    limit = std::clamp(config.initialLimit, config.minLimit, config.maxLimit);
+}
+
+bool AdmissionController::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (waiting == 0 && inflight < static_cast<int>(limit)) {
+        inflight++;
+        counters.admitted++;
+        windowPeakInflight = std::max(windowPeakInflight, inflight);
+        return true;
+    }
+
+    // Shed up front when queueing plus service would already miss the latency
+    // target; the queue timeout below only bounds how long a request may wait.
+    double expectedLatencyMs = estimatedWaitMs(waiting + 1) + averageLatencyMs;
+    if (waiting >= config.maxQueue || expectedLatencyMs > static_cast<double>(config.latencyTarget.count())) {
+        counters.shed++;
+        return false;
+    }
+
+    waiting++;
+    auto deadline = std::chrono::steady_clock::now() + config.queueTimeout;
+    bool admitted = slotFreed.wait_until(lock, deadline, [this] { return inflight < static_cast<int>(limit); });
+    waiting--;
+    if (!admitted) {
+        counters.queueTimeouts++;
+        counters.shed++;
+        return false;
+    }
+    inflight++;
+    counters.admitted++;
+    counters.admittedAfterQueueing++;
+    windowPeakInflight = std::max(windowPeakInflight, inflight);
+    return true;
+}
+
+void AdmissionController::release(std::chrono::nanoseconds handlerLatency) {
+    bool grew;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inflight--;
+        double latencyMs = std::chrono::duration<double, std::milli>(handlerLatency).count();
+        averageLatencyMs = averageLatencyMs == 0 ? latencyMs : averageLatencyMs * 0.9 + latencyMs * 0.1;
+        windowLatencySumMs += latencyMs;
+        windowSamples++;
+        int oldLimit = static_cast<int>(limit);
+        if (windowSamples >= oldLimit) {
+            adjustLimit();
+        }
+        grew = static_cast<int>(limit) > oldLimit;
+    }
+    if (grew) {
+        slotFreed.notify_all();
+    } else {
+        slotFreed.notify_one();
+    }
+}
+
+AdmissionStats AdmissionController::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    AdmissionStats snapshot = counters;
+    snapshot.limit = static_cast<int>(limit);
+    snapshot.inflight = inflight;
+    snapshot.queued = waiting;
+    snapshot.averageLatencyMs = averageLatencyMs;
+    return snapshot;
+}
+
+// Slots free up at roughly limit / averageLatency per millisecond.
+double AdmissionController::estimatedWaitMs(int position) const {
+    return position * averageLatencyMs / std::max(1.0, limit);
+}
+
+void AdmissionController::adjustLimit() {
+    double windowLatencyMs = windowLatencySumMs / windowSamples;
+    if (windowLatencyMs > static_cast<double>(config.latencyTarget.count())) {
+        limit = std::max(config.minLimit, limit * 0.9);
+    } else if (windowPeakInflight >= static_cast<int>(limit) || waiting > 0) {
+        // Only grow while the limit is what's holding requests back.
+        limit = std::min(config.maxLimit, limit + 1);
+    }
+    windowLatencySumMs = 0;
+    windowSamples = 0;
+    windowPeakInflight = inflight;
+}
@@ -0,0 +1,63 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+struct AdmissionConfig {
+    double initialLimit = 20;
+    double minLimit = 1;
+    double maxLimit = 80;
+    int maxQueue = 256;
+    std::chrono::milliseconds queueTimeout{100};
+    std::chrono::milliseconds latencyTarget{50};
+};
+
+struct AdmissionStats {
+    int limit = 0;
+    int inflight = 0;
+    int queued = 0;
+    uint64_t admitted = 0;
+    uint64_t admittedAfterQueueing = 0;
+    uint64_t shed = 0;
+    uint64_t queueTimeouts = 0;
+    double averageLatencyMs = 0;
+};
+
+AdmissionConfig admissionConfigFromMap(const std::map<std::string, std::string>& config);
+
+// Adaptive concurrency limit (AIMD on handler latency) with a short, bounded
+// wait queue. A connection is rejected only when its estimated queueing time
+// plus the average handler latency exceeds the latency target, the queue is
+// full, or it waits longer than the queue timeout.
+class AdmissionController {
+public:
+    void configure(const AdmissionConfig& config);
+    bool acquire();
+    void release(std::chrono::nanoseconds handlerLatency);
+    AdmissionStats stats() const;
+
+private:
+    double estimatedWaitMs(int position) const;
+    void adjustLimit();
+
+    mutable std::mutex mutex;
+    std::condition_variable slotFreed;
+    AdmissionConfig config;
+    double limit = 20;
+    int inflight = 0;
+    int waiting = 0;
+    AdmissionStats counters;
+
+    // Current adjustment window: one window per `limit` completed requests.
+    double averageLatencyMs = 0;
+    double windowLatencySumMs = 0;
+    int windowSamples = 0;
+    int windowPeakInflight = 0;
+};
+
+#endif // ADMISSION_H
@@ -0,0 +1,356 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include <linux/mempolicy.h>
+#include "affinity.h"
+#include "json_writer.h"
+#include "parser.h"
+#include "request_handler.h"
+
+namespace {
+
+const int maxCpus = CPU_SETSIZE;
+const int maxNodes = 64;
+
+struct Placement {
+    bool set = false;
+    cpu_set_t cpus;
+    int preferredNode = -1; // -1 when the CPUs span several nodes
+};
+
+struct ThreadInfo {
+    const char* role;
+    const void* stack;
+};
+
+Placement acceptorPlacement;
+Placement workerPlacement;
+bool reporting = false;
+
+std::mutex registryMutex;
+std::unordered_map<pid_t, ThreadInfo> liveThreads;
+
+std::atomic<uint64_t> connectionsByCpu[maxCpus];
+std::atomic<uint64_t> migratedByCpu[maxCpus];  // connections that finished on another CPU than they started
+std::atomic<uint64_t> arenasByNode[maxNodes + 1]; // last slot: node unknown
+
+bool parseList(const std::string& text, std::vector<int>& values) {
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (part.empty()) {
+            continue;
+        }
+        size_t dash = part.find('-');
+        try {
+            int first = std::stoi(part.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(part.substr(dash + 1));
+            if (first < 0 || last < first) {
+                return false;
+            }
+            for (int value = first; value <= last; value++) {
+                values.push_back(value);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !values.empty();
+}
+
+bool nodeCpus(int node, std::vector<int>& cpus) {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    return file.is_open() && std::getline(file, list) && parseList(list, cpus);
+}
+
+int nodeOfCpu(int cpu) {
+    for (int node = 0; node < maxNodes; node++) {
+        std::vector<int> cpus;
+        if (!nodeCpus(node, cpus)) {
+            continue;
+        }
+        for (int candidate : cpus) {
+            if (candidate == cpu) {
+                return node;
+            }
+        }
+    }
+    return -1;
+}
+
+bool resolve(const std::string& key, const std::string& spec, int workerSlot, Placement& placement) {
+    if (spec.empty()) {
+        return true;
+    }
+    std::vector<int> cpus;
+    if (spec.compare(0, 5, "node:") == 0) {
+        std::vector<int> nodes;
+        if (!parseList(spec.substr(5), nodes)) {
+            std::cerr << "Error: Invalid node list for " << key << ": " << spec << std::endl;
+            return false;
+        }
+        if (workerSlot >= 0) {
+            nodes = {nodes[workerSlot % nodes.size()]};
+        }
+        for (int node : nodes) {
+            if (!nodeCpus(node, cpus)) {
+                std::cerr << "Error: NUMA node " << node << " in " << key << " has no CPUs." << std::endl;
+                return false;
+            }
+        }
+    } else if (!parseList(spec, cpus)) {
+        std::cerr << "Error: Invalid CPU list for " << key << ": " << spec << std::endl;
+        return false;
+    }
+
+    CPU_ZERO(&placement.cpus);
+    int node = -2;
+    for (int cpu : cpus) {
+        if (cpu >= maxCpus) {
+            std::cerr << "Error: CPU " << cpu << " in " << key << " is out of range." << std::endl;
+            return false;
+        }
+        CPU_SET(cpu, &placement.cpus);
+        int cpuNode = nodeOfCpu(cpu);
+        node = node == -2 || node == cpuNode ? cpuNode : -1;
+    }
+    placement.preferredNode = node;
+    placement.set = true;
+    return true;
+}
+
+void apply(const Placement& placement) {
+    if (!placement.set) {
+        return;
+    }
+    if (sched_setaffinity(0, sizeof(placement.cpus), &placement.cpus) != 0) {
+        std::cerr << "Error: sched_setaffinity failed: " << std::strerror(errno) << std::endl;
+    }
+    if (placement.preferredNode >= 0) {
+        unsigned long mask = 1ul << placement.preferredNode;
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8) != 0) {
+            std::cerr << "Error: set_mempolicy failed: " << std::strerror(errno) << std::endl;
+        }
+    }
+}
+
+void registerThread(const char* role, const void* stack) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    liveThreads[static_cast<pid_t>(syscall(SYS_gettid))] = ThreadInfo{role, stack};
+}
+
+// Node holding each page, through move_pages() in query mode; -1 when unknown.
+void memoryNodes(const std::vector<const void*>& addresses, std::vector<int>& nodes) {
+    std::vector<void*> pages;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    for (const void* address : addresses) {
+        pages.push_back(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(address) & ~static_cast<uintptr_t>(pageSize - 1)));
+    }
+    nodes.assign(pages.size(), -1);
+    if (!pages.empty() && syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, nodes.data(), 0) != 0) {
+        nodes.assign(pages.size(), -1);
+    }
+    for (int& node : nodes) {
+        node = node < 0 ? -1 : node;
+    }
+}
+
+// Field 39 of /proc/self/task/<tid>/stat is the CPU the thread last ran on.
+int lastCpu(pid_t tid) {
+    std::ifstream file("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string stat;
+    if (!std::getline(file, stat)) {
+        return -1;
+    }
+    size_t close = stat.rfind(')');
+    if (close == std::string::npos) {
+        return -1;
+    }
+    std::stringstream fields(stat.substr(close + 2));
+    std::string field;
+    for (int index = 3; index <= 39 && fields >> field; index++) {
+        if (index == 39) {
+            return std::atoi(field.c_str());
+        }
+    }
+    return -1;
+}
+
+std::string cpuList(const cpu_set_t& cpus) {
+    std::string list;
+    for (int cpu = 0; cpu < maxCpus; cpu++) {
+        if (!CPU_ISSET(cpu, &cpus)) {
+            continue;
+        }
+        int last = cpu;
+        while (last + 1 < maxCpus && CPU_ISSET(last + 1, &cpus)) {
+            last++;
+        }
+        list += (list.empty() ? "" : ",") + std::to_string(cpu);
+        if (last > cpu) {
+            list += "-" + std::to_string(last);
+        }
+        cpu = last;
+    }
+    return list;
+}
+
+} // namespace
+
+AffinityConfig affinityConfigFromMap(const std::map<std::string, std::string>& config) {
+    AffinityConfig affinity;
+    affinity.acceptor = getConfigValue(config, "acceptor_affinity", "");
+    affinity.workers = getConfigValue(config, "worker_affinity", "");
+    affinity.report = getConfigNumber(config, "affinity_report", 0) != 0;
+    return affinity;
+}
+
+bool configureAffinity(const AffinityConfig& config, int workerSlot) {
+    if (!resolve("acceptor_affinity", config.acceptor, workerSlot, acceptorPlacement) ||
+        !resolve("worker_affinity", config.workers, workerSlot, workerPlacement)) {
+        return false;
+    }
+    reporting = config.report;
+    apply(workerPlacement);
+    return true;
+}
+
+void pinAcceptorThread() {
+    apply(acceptorPlacement);
+    if (reporting) {
+        int marker = 0;
+        registerThread("acceptor", &marker);
+    }
+}
+
+void pinWorkerThread() {
+    apply(workerPlacement);
+}
+
+int affinityConnectionBegin() {
+    if (!reporting) {
+        return -1;
+    }
+    int marker = 0;
+    registerThread("connection", &marker);
+    return sched_getcpu();
+}
+
+void affinityConnectionEnd(int startCpu, const void* arenaBuffer) {
+    if (!reporting) {
+        return;
+    }
+    int endCpu = sched_getcpu();
+    if (endCpu >= 0 && endCpu < maxCpus) {
+        connectionsByCpu[endCpu]++;
+        if (startCpu != endCpu) {
+            migratedByCpu[endCpu]++;
+        }
+    }
+    std::vector<int> nodes;
+    memoryNodes({arenaBuffer}, nodes);
+    arenasByNode[nodes[0] >= 0 && nodes[0] < maxNodes ? nodes[0] : maxNodes]++;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    liveThreads.erase(static_cast<pid_t>(syscall(SYS_gettid)));
+}
+
+void dumpAffinityReport(std::pmr::string& out) {
+    std::vector<std::pair<pid_t, ThreadInfo>> threads;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threads.assign(liveThreads.begin(), liveThreads.end());
+    }
+    std::vector<const void*> stacks;
+    for (const auto& thread : threads) {
+        stacks.push_back(thread.second.stack);
+    }
+    std::vector<int> stackNodes;
+    memoryNodes(stacks, stackNodes);
+
+    JsonWriter json(out);
+    json.beginObject();
+    json.key("reporting");
+    json.boolean(reporting);
+    json.key("acceptor_cpus");
+    json.string(acceptorPlacement.set ? cpuList(acceptorPlacement.cpus) : "");
+    json.key("worker_cpus");
+    json.string(workerPlacement.set ? cpuList(workerPlacement.cpus) : "");
+
+    json.key("threads");
+    json.beginArray();
+    for (size_t i = 0; i < threads.size(); i++) {
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        sched_getaffinity(threads[i].first, sizeof(allowed), &allowed);
+        json.beginObject();
+        json.key("tid");
+        json.number(threads[i].first);
+        json.key("role");
+        json.string(threads[i].second.role);
+        json.key("allowed_cpus");
+        json.string(cpuList(allowed));
+        json.key("last_cpu");
+        json.number(lastCpu(threads[i].first));
+        json.key("stack_node");
+        json.number(stackNodes[i]);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("connections_by_cpu");
+    json.beginObject();
+    for (int cpu = 0; cpu < maxCpus; cpu++) {
+        uint64_t count = connectionsByCpu[cpu].load(std::memory_order_relaxed);
+        if (count > 0) {
+            json.key(std::to_string(cpu));
+            json.beginObject();
+            json.key("connections");
+            json.number(count);
+            json.key("migrated");
+            json.number(migratedByCpu[cpu].load(std::memory_order_relaxed));
+            json.endObject();
+        }
+    }
+    json.endObject();
+
+    json.key("arena_pages_by_node");
+    json.beginObject();
+    for (int node = 0; node <= maxNodes; node++) {
+        uint64_t count = arenasByNode[node].load(std::memory_order_relaxed);
+        if (count > 0) {
+            json.key(node == maxNodes ? std::string("unknown") : std::to_string(node));
+            json.number(count);
+        }
+    }
+    json.endObject();
+
+    std::vector<const void*> contents;
+    fileCache.sampleContents(contents, 1024);
+    std::vector<int> contentNodes;
+    memoryNodes(contents, contentNodes);
+    std::map<int, uint64_t> cacheNodes;
+    for (int node : contentNodes) {
+        cacheNodes[node]++;
+    }
+    json.key("file_cache_entries_by_node");
+    json.beginObject();
+    for (const auto& node : cacheNodes) {
+        json.key(node.first < 0 ? std::string("unknown") : std::to_string(node.first));
+        json.number(node.second);
+    }
+    json.endObject();
+    json.endObject();
+}
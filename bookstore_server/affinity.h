@@ -0,0 +1,40 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <map>
+#include <memory_resource>
+#include <string>
+
+// CPU / NUMA placement of server threads. A spec is either a CPU list
+// ("0-3,8") or a NUMA node list ("node:0,1"). With a node list in prefork
+// mode, each worker process takes one node round-robin by slot and prefers
+// that node for all of its memory; otherwise threads get the union of the
+// listed CPUs. Threads whose CPUs sit on a single node also prefer it for
+// allocations, so file cache entries and arenas are first touched locally.
+struct AffinityConfig {
+    std::string acceptor; // accept loop thread
+    std::string workers;  // connection threads and background threads
+    bool report = false;  // track placement for GET /debug/affinity
+};
+
+AffinityConfig affinityConfigFromMap(const std::map<std::string, std::string>& config);
+
+// Resolves the specs for this process (workerSlot is -1 outside prefork) and
+// applies the worker placement to the calling thread, so threads it starts
+// afterwards inherit it. Returns false on an invalid spec.
+bool configureAffinity(const AffinityConfig& config, int workerSlot);
+
+void pinAcceptorThread();
+// Called at the start of every connection thread; free when nothing is configured.
+void pinWorkerThread();
+
+// Bracket a connection when reporting is enabled: records which CPU the
+// thread started and finished on and which node holds its arena buffer.
+int affinityConnectionBegin();
+void affinityConnectionEnd(int startCpu, const void* arenaBuffer);
+
+// Live threads (role, allowed CPUs, CPU last run on, node of the stack),
+// per-CPU connection counts and the nodes holding file cache contents, as JSON.
+void dumpAffinityReport(std::pmr::string& out);
+
+#endif // AFFINITY_H
@@ -0,0 +1,58 @@
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "arena.h"
+
+Arena::Arena(void* initialBuffer, size_t size)
+    : initial(static_cast<char*>(initialBuffer)), initialSize(size), cursor(initial), limit(initial + size) {}
+
+Arena::~Arena() {
+    while (blocks) {
+        Block* next = blocks->next;
+        std::free(blocks);
+        blocks = next;
+    }
+}
+
+void Arena::reset() {
+    cursor = initial;
+    limit = initial + initialSize;
+    current = nullptr;
+    used = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (aligned + bytes <= reinterpret_cast<uintptr_t>(limit)) {
+        cursor = reinterpret_cast<char*>(aligned + bytes);
+        used += bytes;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    // Move to the next retained block if it is big enough, otherwise splice in a new one.
+    size_t needed = bytes + alignment + sizeof(Block);
+    Block* next = current ? current->next : blocks;
+    if (!next || next->size < needed) {
+        size_t size = 16 * 1024;
+        size_t previous = current ? current->size : initialSize;
+        while (size < needed || size < 2 * previous) {
+            size *= 2;
+        }
+        Block* block = static_cast<Block*>(std::malloc(size));
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        block->size = size;
+        block->next = next;
+        if (current) {
+            current->next = block;
+        } else {
+            blocks = block;
+        }
+        next = block;
+    }
+    current = next;
+    cursor = reinterpret_cast<char*>(current + 1);
+    limit = reinterpret_cast<char*>(current) + current->size;
+    return do_allocate(bytes, alignment);
+}
@@ -0,0 +1,41 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Bump allocator for per-connection request/response data. Allocation is a
+// pointer increment; deallocation is a no-op and everything is released at
+// once by reset(). Overflow blocks are kept across resets so a connection
+// stops calling malloc once it has seen its largest request.
+class Arena : public std::pmr::memory_resource {
+public:
+    Arena(void* initialBuffer, size_t initialSize);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void reset();
+    size_t bytesUsed() const { return used; }
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    char* initial;
+    size_t initialSize;
+    char* cursor;
+    char* limit;
+    Block* blocks = nullptr;  // overflow blocks in allocation order
+    Block* current = nullptr; // block being filled, nullptr while in the initial buffer
+    size_t used = 0;
+};
+
+#endif // ARENA_H
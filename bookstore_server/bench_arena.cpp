@@ -0,0 +1,112 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include "request_handler.h"
+
+// Compares heap allocations and throughput of the arena-backed request path
+// against the previous std::string-based one. Sockets are left out so the
+// numbers reflect parsing and response assembly only.
+// Usage: bench_arena [web_root] [iterations]
+
+static unsigned long long allocationCount = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// The request path as it was before the arena: every field is a std::string.
+std::string legacyMimeType(const std::string& filename) {
+    if (filename.find(".html") != std::string::npos) return "text/html";
+    if (filename.find(".css") != std::string::npos) return "text/css";
+    if (filename.find(".js") != std::string::npos) return "application/javascript";
+    if (filename.find(".png") != std::string::npos) return "image/png";
+    if (filename.find(".jpg") != std::string::npos) return "image/jpeg";
+    return "text/plain";
+}
+
+std::string legacyHandleRequest(const std::string& request, const std::string& webRoot, std::string& method, std::string& resource) {
+    std::string protocol;
+    std::istringstream requestStream(request);
+    requestStream >> method >> resource >> protocol;
+    if (resource == "/") {
+        resource = "/index.html";
+    }
+    std::string filePath = webRoot + resource;
+    FileStatus status;
+    auto file = fileCache.get(filePath, status);
+    if (status == FileStatus::Ok) {
+        return "HTTP/1.1 200 OK\r\nContent-Type: " + legacyMimeType(filePath) + "\r\n\r\n" + file->content;
+    }
+    return "HTTP/1.1 404 Not Found\r\n\r\n";
+}
+
+size_t legacyRequest(const char* buffer, size_t len, const std::string& webRoot) {
+    std::string request(buffer, len);
+    std::string method, resource;
+    std::string response = legacyHandleRequest(request, webRoot, method, resource);
+    std::string status = response.substr(9, 3);
+    return response.size() + status.size();
+}
+
+size_t arenaRequest(const char* buffer, size_t len, const std::string& webRoot, Arena& arena) {
+    size_t bytes;
+    {
+        HttpRequest request;
+        parseRequest(std::string_view(buffer, len), request);
+        HttpResponse response(arena);
+        handleRequest(request, webRoot, arena, response);
+        bytes = response.headers.size() + (response.file ? response.file->content.size() : response.body.size());
+    }
+    arena.reset();
+    return bytes;
+}
+
+template <typename Fn>
+void run(const char* name, long iterations, Fn fn) {
+    size_t sink = 0;
+    unsigned long long before = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        sink += fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << name << ": " << static_cast<double>(allocationCount - before) / iterations << " allocations/request, "
+              << static_cast<long>(iterations / seconds) << " requests/s (checksum " << sink << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string webRoot = argc > 1 ? argv[1] : "web";
+    long iterations = argc > 2 ? std::atol(argv[2]) : 200000;
+    const char request[] = "GET /index.html HTTP/1.1\r\nHost: localhost\r\nUser-Agent: bench\r\nAccept: */*\r\n\r\n";
+    size_t len = std::strlen(request);
+
+    FileStatus status;
+    if (!fileCache.get(webRoot + "/index.html", status)) {
+        std::cerr << "Error: " << webRoot << "/index.html is not readable." << std::endl;
+        return 1;
+    }
+
+    alignas(std::max_align_t) char arenaBuffer[4096];
+    Arena arena(arenaBuffer, sizeof(arenaBuffer));
+
+    run("std::string path", iterations, [&] { return legacyRequest(request, len, webRoot); });
+    run("arena path", iterations, [&] { return arenaRequest(request, len, webRoot, arena); });
+    return 0;
+}
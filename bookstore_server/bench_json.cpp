@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "json_writer.h"
+
+// Measures JSON assembly for large /resources-style listings and for
+// number-heavy /stats-style objects. The output buffer is reused between
+// iterations, as the connection arena is between requests.
+// Usage: bench_json [entries] [iterations]
+
+// listResources before JsonWriter: std::string += with no escaping at all.
+void legacyListing(const std::vector<std::string>& names, std::pmr::string& out) {
+    out = "{ \"resources\": [";
+    for (const std::string& name : names) {
+        out += "\"";
+        out += name;
+        out += "\",";
+    }
+    if (out.back() == ',') {
+        out.pop_back();
+    }
+    out += "] }";
+}
+
+// Correct but byte-at-a-time escaping, as the old trace dump did it.
+void bytewiseListing(const std::vector<std::string>& names, std::pmr::string& out) {
+    out = "{\"resources\":[";
+    bool first = true;
+    for (const std::string& name : names) {
+        if (!first) {
+            out.push_back(',');
+        }
+        first = false;
+        out.push_back('"');
+        for (char c : name) {
+            unsigned char ch = static_cast<unsigned char>(c);
+            if (ch == '"' || ch == '\\') {
+                out.push_back('\\');
+                out.push_back(c);
+            } else if (ch < 0x20) {
+                out += "\\u00";
+                out.push_back("0123456789abcdef"[ch >> 4]);
+                out.push_back("0123456789abcdef"[ch & 0xf]);
+            } else {
+                out.push_back(c);
+            }
+        }
+        out.push_back('"');
+    }
+    out += "]}";
+}
+
+void writerListing(const std::vector<std::string>& names, std::pmr::string& out) {
+    out.clear();
+    JsonWriter json(out);
+    json.beginObject();
+    json.key("resources");
+    json.beginArray();
+    for (const std::string& name : names) {
+        json.string(name);
+    }
+    json.endArray();
+    json.endObject();
+}
+
+void legacyNumbers(const std::vector<unsigned long long>& values, std::pmr::string& out) {
+    out = "{";
+    for (size_t i = 0; i < values.size(); i++) {
+        out += "\"n\": " + std::to_string(values[i]) + ", \"x\": " + std::to_string(static_cast<double>(values[i]) / 7.0) + ",";
+    }
+    out.back() = '}';
+}
+
+void writerNumbers(const std::vector<unsigned long long>& values, std::pmr::string& out) {
+    out.clear();
+    JsonWriter json(out);
+    json.beginObject();
+    for (unsigned long long value : values) {
+        json.key("n");
+        json.number(value);
+        json.key("x");
+        json.number(static_cast<double>(value) / 7.0);
+    }
+    json.endObject();
+}
+
+template <typename Fn>
+void run(const char* name, long iterations, size_t entries, std::pmr::string& out, Fn fn) {
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        fn(out);
+        bytes += out.size();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << seconds * 1e9 / (static_cast<double>(iterations) * entries) << " ns/entry, "
+              << static_cast<double>(bytes) / seconds / (1024 * 1024) << " MiB/s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t entries = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    long iterations = argc > 2 ? std::atol(argv[2]) : 50;
+
+    // Typical web_root names, with an occasional one that needs escaping.
+    std::vector<std::string> names;
+    std::vector<unsigned long long> values;
+    names.reserve(entries);
+    for (size_t i = 0; i < entries; i++) {
+        std::string name = "assets/catalog/book-cover-" + std::to_string(i) + "-thumbnail-large.webp";
+        if (i % 100 == 0) {
+            name += " \"draft\"";
+        }
+        names.push_back(name);
+        values.push_back(i * 2654435761ull % 1000000007ull);
+    }
+
+    std::pmr::string out;
+    out.reserve(entries * 96);
+    run("listing, std::string += (unescaped)", iterations, entries, out, [&](std::pmr::string& o) { legacyListing(names, o); });
+    run("listing, bytewise escape", iterations, entries, out, [&](std::pmr::string& o) { bytewiseListing(names, o); });
+    run("listing, JsonWriter", iterations, entries, out, [&](std::pmr::string& o) { writerListing(names, o); });
+    run("numbers, std::to_string", iterations, entries, out, [&](std::pmr::string& o) { legacyNumbers(values, o); });
+    run("numbers, JsonWriter", iterations, entries, out, [&](std::pmr::string& o) { writerNumbers(values, o); });
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bundle.h"
+
+WebBundle::~WebBundle() {
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+}
+
+bool WebBundle::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "Error: Unable to open bundle: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(BundleHeader)) {
+        close(fd);
+        std::cerr << "Error: Invalid bundle: " << path << std::endl;
+        return false;
+    }
+    size_t mappedSize = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Unable to map bundle: " << path << std::endl;
+        return false;
+    }
+
+    const char* bytes = static_cast<const char*>(mapped);
+    const BundleHeader* candidate = reinterpret_cast<const BundleHeader*>(bytes);
+    uint64_t entryTotal = static_cast<uint64_t>(candidate->entryCount) + (candidate->notFoundEntry != bundleNoEntry ? 1 : 0);
+    bool valid = std::memcmp(candidate->magic, bundleMagic, sizeof(bundleMagic)) == 0 &&
+                 candidate->version == bundleVersion &&
+                 candidate->slotCount > 0 && (candidate->slotCount & (candidate->slotCount - 1)) == 0 &&
+                 candidate->entriesOffset + entryTotal * sizeof(BundleEntry) <= mappedSize &&
+                 candidate->slotsOffset + static_cast<uint64_t>(candidate->slotCount) * sizeof(uint32_t) <= mappedSize &&
+                 (candidate->notFoundEntry == bundleNoEntry || candidate->notFoundEntry == candidate->entryCount);
+    const BundleEntry* table = reinterpret_cast<const BundleEntry*>(bytes + candidate->entriesOffset);
+    for (uint64_t i = 0; valid && i < entryTotal; i++) {
+        const BundleEntry& entry = table[i];
+        valid = entry.pathOffset + entry.pathLength <= mappedSize &&
+                entry.responseOffset + entry.headersLength + entry.bodyLength <= mappedSize &&
+                entry.gzipResponseOffset + entry.gzipHeadersLength + entry.gzipBodyLength <= mappedSize;
+    }
+    if (!valid) {
+        munmap(mapped, mappedSize);
+        std::cerr << "Error: Invalid bundle: " << path << std::endl;
+        return false;
+    }
+
+    data = bytes;
+    size = mappedSize;
+    header = candidate;
+    entries = table;
+    slots = reinterpret_cast<const uint32_t*>(bytes + header->slotsOffset);
+    return true;
+}
+
+BundleResponse WebBundle::responseFor(const BundleEntry& entry, bool acceptGzip) const {
+    BundleResponse response;
+    response.status = entry.status;
+    // The ETag comes from the head that is actually served: the variants differ.
+    std::string_view head;
+    if (acceptGzip && entry.gzipResponseOffset != 0) {
+        response.bytes = std::string_view(data + entry.gzipResponseOffset, entry.gzipHeadersLength + entry.gzipBodyLength);
+        head = response.bytes.substr(0, entry.gzipHeadersLength);
+    } else {
+        response.bytes = std::string_view(data + entry.responseOffset, entry.headersLength + entry.bodyLength);
+        head = response.bytes.substr(0, entry.headersLength);
+    }
+    size_t etag = head.find("\r\nETag: ");
+    if (etag != std::string_view::npos) {
+        size_t start = etag + 8;
+        response.etag = head.substr(start, head.find("\r\n", start) - start);
+    }
+    return response;
+}
+
+bool WebBundle::find(std::string_view path, bool acceptGzip, BundleResponse& response) const {
+    if (!header) {
+        return false;
+    }
+    uint64_t hash = bundlePathHash(path);
+    uint32_t mask = header->slotCount - 1;
+    for (uint32_t probe = 0; probe <= mask; probe++) {
+        uint32_t slot = slots[(hash + probe) & mask];
+        if (slot == 0 || slot > header->entryCount) {
+            return false;
+        }
+        const BundleEntry& entry = entries[slot - 1];
+        if (entry.pathHash == hash && std::string_view(data + entry.pathOffset, entry.pathLength) == path) {
+            response = responseFor(entry, acceptGzip);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WebBundle::notFound(bool acceptGzip, BundleResponse& response) const {
+    if (!header || header->notFoundEntry == bundleNoEntry) {
+        return false;
+    }
+    response = responseFor(entries[header->notFoundEntry], acceptGzip);
+    return true;
+}
@@ -0,0 +1,103 @@
+#ifndef BUNDLE_H
+#define BUNDLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+// Web-root bundle written by webroot_pack and served from an mmap.
+//
+//   BundleHeader
+//   BundleEntry[entryCount]         -- plus one trailing not-found entry if present
+//   uint32_t slots[slotCount]       -- open-addressed path index, entry index + 1, 0 = empty
+//   path strings, then per entry: headers immediately followed by the body,
+//   and optionally gzip headers immediately followed by the gzip body
+//
+// Headers are complete HTTP response heads (status line, Content-Type,
+// Content-Length, ETag, blank line), so a hit is a single send() of one
+// contiguous range. Each variant's ETag is bundleETag of its own body, so the
+// identity and gzip representations never share one. Integers are stored in
+// host (little-endian) order.
+
+const char bundleMagic[4] = {'B', 'S', 'W', 'B'};
+const uint32_t bundleVersion = 1;
+const uint32_t bundleNoEntry = UINT32_MAX;
+
+struct BundleHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t slotCount;       // power of two
+    uint32_t notFoundEntry;   // index of the 404 response, bundleNoEntry if none
+    uint32_t reserved;
+    uint64_t entriesOffset;
+    uint64_t slotsOffset;
+};
+
+struct BundleEntry {
+    uint64_t pathHash;
+    uint64_t pathOffset;
+    uint64_t responseOffset;      // headers, then body
+    uint64_t headersLength;
+    uint64_t bodyLength;
+    uint64_t gzipResponseOffset;  // 0 when there is no gzip variant
+    uint64_t gzipHeadersLength;
+    uint64_t gzipBodyLength;
+    uint32_t pathLength;
+    uint16_t status;
+    uint16_t reserved;
+};
+
+static_assert(sizeof(BundleHeader) == 40, "BundleHeader layout is part of the file format");
+static_assert(sizeof(BundleEntry) == 72, "BundleEntry layout is part of the file format");
+
+inline uint64_t bundlePathHash(std::string_view path) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : path) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Quoted ETag of one stored representation: the path hash of its body bytes.
+inline std::string bundleETag(std::string_view body) {
+    char etag[24];
+    std::snprintf(etag, sizeof(etag), "\"%016llx\"", static_cast<unsigned long long>(bundlePathHash(body)));
+    return etag;
+}
+
+// A complete response stored in the bundle: head and body are contiguous.
+struct BundleResponse {
+    std::string_view bytes;
+    std::string_view etag; // quoted, as it appears in the ETag header
+    int status = 0;
+};
+
+class WebBundle {
+public:
+    WebBundle() = default;
+    ~WebBundle();
+    WebBundle(const WebBundle&) = delete;
+    WebBundle& operator=(const WebBundle&) = delete;
+
+    bool open(const std::string& path);
+    bool isOpen() const { return data != nullptr; }
+    size_t entryCount() const { return header ? header->entryCount : 0; }
+
+    // Looks up an exact path such as "/index.html"; no syscalls, no allocation.
+    bool find(std::string_view path, bool acceptGzip, BundleResponse& response) const;
+    bool notFound(bool acceptGzip, BundleResponse& response) const;
+
+private:
+    BundleResponse responseFor(const BundleEntry& entry, bool acceptGzip) const;
+
+    const char* data = nullptr;
+    size_t size = 0;
+    const BundleHeader* header = nullptr;
+    const BundleEntry* entries = nullptr;
+    const uint32_t* slots = nullptr;
+};
+
+#endif // BUNDLE_H
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "access_log.h"
+#include "cache_warmup.h"
+#include "parser.h"
+#include "request_handler.h"
+
+namespace {
+
+struct Candidate {
+    std::string resource;
+    uint64_t hits;
+    uint64_t size;
+};
+
+// Counts successful hits per resource in "[timestamp] METHOD resource status ip Nms" lines.
+void countTextLog(const std::string& path, uint64_t tailBytes, std::unordered_map<std::string, uint64_t>& hits) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return;
+    }
+    std::streamoff size = file.tellg();
+    std::streamoff start = size > static_cast<std::streamoff>(tailBytes) ? size - static_cast<std::streamoff>(tailBytes) : 0;
+    file.seekg(start);
+    std::string line;
+    if (start > 0) {
+        std::getline(file, line); // skip the partial first line
+    }
+    while (std::getline(file, line)) {
+        size_t close = line.find("] ");
+        if (close == std::string::npos) {
+            continue;
+        }
+        size_t methodEnd = line.find(' ', close + 2);
+        size_t resourceEnd = methodEnd == std::string::npos ? std::string::npos : line.find(' ', methodEnd + 1);
+        if (resourceEnd == std::string::npos || line.compare(resourceEnd + 1, 4, "200 ") != 0) {
+            continue;
+        }
+        hits[line.substr(methodEnd + 1, resourceEnd - methodEnd - 1)]++;
+    }
+}
+
+bool isBinaryLog(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, "BSRL", 4) == 0;
+}
+
+void runWarmup(WarmupConfig config, std::string webRoot) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::unordered_map<std::string, uint64_t> hits;
+    if (isBinaryLog(config.logPath)) {
+        readBinaryAccessLog(config.logPath, [&hits](const AccessLogRecord& record) {
+            if (record.status == 200) {
+                hits[record.resource]++;
+            }
+        });
+    } else {
+        countTextLog(config.logPath, config.logTailBytes, hits);
+    }
+
+    std::vector<Candidate> candidates;
+    for (const auto& entry : hits) {
+        const std::string& resource = entry.first;
+        if (resource.empty() || resource[0] != '/' || resource.find("..") != std::string::npos) {
+            continue;
+        }
+        struct stat st;
+        if (stat((webRoot + resource).c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            candidates.push_back({resource, entry.second, static_cast<uint64_t>(st.st_size)});
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.hits * std::max<uint64_t>(a.size, 1) > b.hits * std::max<uint64_t>(b.size, 1);
+    });
+
+    std::vector<Candidate> selected;
+    uint64_t plannedBytes = 0;
+    for (const Candidate& candidate : candidates) {
+        if (selected.size() >= config.topFiles) {
+            break;
+        }
+        if (plannedBytes + candidate.size > config.budgetBytes) {
+            continue;
+        }
+        plannedBytes += candidate.size;
+        selected.push_back(candidate);
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> loaded{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::max(1u, config.threads); t++) {
+        workers.emplace_back([&] {
+            size_t index;
+            while ((index = next.fetch_add(1)) < selected.size()) {
+                std::string path = webRoot + selected[index].resource;
+                // Files too large for fileCache still benefit from a warm page cache.
+                int fd = open(path.c_str(), O_RDONLY);
+                if (fd != -1) {
+                    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+                    close(fd);
+                }
+                FileStatus status;
+                if (fileCache.get(path, status)) {
+                    loaded++;
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Cache warmup: preloaded " << loaded.load() << " of " << selected.size() << " files ("
+              << plannedBytes << " bytes) in " << elapsed << "ms." << std::endl;
+}
+
+} // namespace
+
+WarmupConfig warmupConfigFromMap(const std::map<std::string, std::string>& config) {
+    WarmupConfig warmup;
+    warmup.enabled = getConfigNumber(config, "warmup", 0) != 0;
+    warmup.logPath = getConfigValue(config, "warmup_log", "");
+    warmup.topFiles = static_cast<size_t>(getConfigNumber(config, "warmup_top", static_cast<long long>(warmup.topFiles)));
+    warmup.budgetBytes = static_cast<uint64_t>(getConfigNumber(config, "warmup_budget_bytes", static_cast<long long>(warmup.budgetBytes)));
+    warmup.threads = static_cast<unsigned>(getConfigNumber(config, "warmup_threads", warmup.threads));
+    warmup.logTailBytes = static_cast<uint64_t>(getConfigNumber(config, "warmup_log_bytes", static_cast<long long>(warmup.logTailBytes)));
+    return warmup;
+}
+
+void startCacheWarmup(const WarmupConfig& config, const std::string& webRoot) {
+    if (!config.enabled) {
+        return;
+    }
+    std::thread(runWarmup, config, webRoot).detach();
+}
@@ -0,0 +1,24 @@
+#ifndef CACHE_WARMUP_H
+#define CACHE_WARMUP_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+struct WarmupConfig {
+    bool enabled = false;
+    std::string logPath; // warmup_log; empty means the access log this process replaced at startup
+    size_t topFiles = 100;
+    uint64_t budgetBytes = 32 * 1024 * 1024;
+    unsigned threads = 4;
+    uint64_t logTailBytes = 16 * 1024 * 1024; // only the most recent part of a text log is read
+};
+
+WarmupConfig warmupConfigFromMap(const std::map<std::string, std::string>& config);
+
+// Ranks resources from the access log by hits x size and preloads the best
+// ones into fileCache under the byte budget. Runs on a detached thread so the
+// caller can start accepting connections right away.
+void startCacheWarmup(const WarmupConfig& config, const std::string& webRoot);
+
+#endif // CACHE_WARMUP_H
@@ -0,0 +1,152 @@
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include "file_cache.h"
+
+void FileCache::setLimits(uint64_t newMaxBytes, uint64_t newMaxFileBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxBytes = newMaxBytes;
+    maxFileBytes = newMaxFileBytes;
+    while (counters.bytes > maxBytes && !lru.empty()) {
+        erase(entries.find(lru.back()));
+        counters.evictions++;
+    }
+}
+
+std::shared_ptr<const CachedFile> FileCache::get(std::string_view path, FileStatus& status) {
+    // stat() needs a terminated path; a stack copy keeps hits allocation-free.
+    char terminatedPath[PATH_MAX];
+    if (path.size() >= sizeof(terminatedPath)) {
+        status = FileStatus::NotFound;
+        return nullptr;
+    }
+    std::memcpy(terminatedPath, path.data(), path.size());
+    terminatedPath[path.size()] = '\0';
+
+    struct stat st;
+    if (stat(terminatedPath, &st) != 0 || !S_ISREG(st.st_mode)) {
+        status = FileStatus::NotFound;
+        return nullptr;
+    }
+
+    std::shared_future<LoadResult> pending;
+    std::unique_ptr<std::promise<LoadResult>> promise; // only created on a miss, keeping hits allocation-free
+    std::string ownedPath; // likewise only filled on a miss
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(path);
+        if (it != entries.end()) {
+            const CachedFile& file = *it->second.file;
+            if (file.size == static_cast<uint64_t>(st.st_size) &&
+                file.modified.tv_sec == st.st_mtim.tv_sec && file.modified.tv_nsec == st.st_mtim.tv_nsec) {
+                counters.hits++;
+                lru.splice(lru.begin(), lru, it->second.lruPosition);
+                status = FileStatus::Ok;
+                return it->second.file;
+            }
+            erase(it);
+        }
+
+        ownedPath.assign(path);
+        auto flight = inflight.find(ownedPath);
+        if (flight != inflight.end()) {
+            counters.coalesced++;
+            pending = flight->second;
+        } else {
+            counters.misses++;
+            promise = std::make_unique<std::promise<LoadResult>>();
+            inflight.emplace(ownedPath, promise->get_future().share());
+        }
+    }
+
+    if (pending.valid()) {
+        LoadResult result = pending.get();
+        status = result.second;
+        return result.first;
+    }
+
+    LoadResult result{nullptr, FileStatus::ReadError};
+    try {
+        result = load(ownedPath, st);
+    } catch (const std::exception&) {
+        // Waiters still need an answer, so a failed read is published as ReadError.
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result.first) {
+            insert(ownedPath, result.first);
+        }
+        inflight.erase(ownedPath);
+    }
+    promise->set_value(result);
+    status = result.second;
+    return result.first;
+}
+
+void FileCache::invalidate(std::string_view path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(path);
+    if (it != entries.end()) {
+        erase(it);
+    }
+}
+
+FileCacheStats FileCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    FileCacheStats snapshot = counters;
+    snapshot.entries = entries.size();
+    return snapshot;
+}
+
+void FileCache::sampleContents(std::vector<const void*>& addresses, size_t maxEntries) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& entry : entries) {
+        if (addresses.size() >= maxEntries) {
+            break;
+        }
+        if (!entry.second.file->content.empty()) {
+            addresses.push_back(entry.second.file->content.data());
+        }
+    }
+}
+
+FileCache::LoadResult FileCache::load(const std::string& path, const struct stat& st) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return {nullptr, FileStatus::ReadError};
+    }
+    auto loaded = std::make_shared<CachedFile>();
+    loaded->content.reserve(static_cast<size_t>(st.st_size));
+    loaded->content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    loaded->modified = st.st_mtim;
+    loaded->size = static_cast<uint64_t>(st.st_size);
+    return {loaded, FileStatus::Ok};
+}
+
+void FileCache::insert(std::string_view path, const std::shared_ptr<const CachedFile>& file) {
+    uint64_t size = file->content.size();
+    if (size > maxFileBytes || size > maxBytes) {
+        return;
+    }
+    auto existing = entries.find(path);
+    if (existing != entries.end()) {
+        erase(existing);
+    }
+    while (counters.bytes + size > maxBytes && !lru.empty()) {
+        erase(entries.find(lru.back()));
+        counters.evictions++;
+    }
+    lru.emplace_front(path);
+    entries.emplace(std::string_view(lru.front()), Entry{file, lru.begin()});
+    counters.bytes += size;
+}
+
+void FileCache::erase(std::unordered_map<std::string_view, Entry>::iterator it) {
+    counters.bytes -= it->second.file->content.size();
+    // The key views the lru node's string, so the entry goes first.
+    auto lruPosition = it->second.lruPosition;
+    entries.erase(it);
+    lru.erase(lruPosition);
+}
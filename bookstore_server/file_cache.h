@@ -0,0 +1,68 @@
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include <cstdint>
+#include <ctime>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <sys/stat.h>
+
+struct CachedFile {
+    std::string content;
+    struct timespec modified;
+    uint64_t size;
+};
+
+struct FileCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t coalesced = 0; // misses that waited on another request's load
+    uint64_t evictions = 0;
+    uint64_t bytes = 0;
+    uint64_t entries = 0;
+};
+
+enum class FileStatus { Ok, NotFound, ReadError };
+
+// In-memory cache of web_root files. Entries are revalidated against the file's
+// mtime and size on every lookup; concurrent misses for the same path share a
+// single disk read (single-flight). Lookups take a string_view, so a hit never
+// builds a std::string for the path.
+class FileCache {
+public:
+    void setLimits(uint64_t maxBytes, uint64_t maxFileBytes);
+    std::shared_ptr<const CachedFile> get(std::string_view path, FileStatus& status);
+    void invalidate(std::string_view path);
+    FileCacheStats stats() const;
+    // Start addresses of up to maxEntries cached contents, for memory placement reports.
+    void sampleContents(std::vector<const void*>& addresses, size_t maxEntries) const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const CachedFile> file;
+        std::list<std::string>::iterator lruPosition;
+    };
+    using LoadResult = std::pair<std::shared_ptr<const CachedFile>, FileStatus>;
+
+    LoadResult load(const std::string& path, const struct stat& st);
+    void insert(std::string_view path, const std::shared_ptr<const CachedFile>& file);
+    void erase(std::unordered_map<std::string_view, Entry>::iterator it);
+
+    mutable std::mutex mutex;
+    // Keys view the path strings owned by the matching lru node, which outlives
+    // the entry; C++17 unordered_map has no heterogeneous lookup on std::string.
+    std::unordered_map<std::string_view, Entry> entries;
+    std::list<std::string> lru; // most recently used at the front
+    std::unordered_map<std::string, std::shared_future<LoadResult>> inflight;
+    uint64_t maxBytes = 64 * 1024 * 1024;
+    uint64_t maxFileBytes = 1024 * 1024;
+    FileCacheStats counters;
+};
+
+#endif // FILE_CACHE_H
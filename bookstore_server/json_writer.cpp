@@ -0,0 +1,69 @@
+#include <cstring>
+#include "json_writer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+// Length of the leading run of bytes that can be copied unchanged.
+size_t plainPrefix(const char* text, size_t size) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        // max(c, 0x1f) == 0x1f exactly when c <= 0x1f as an unsigned byte.
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                       _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+        int mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+    while (i < size && !needsEscape(static_cast<unsigned char>(text[i]))) {
+        i++;
+    }
+    return i;
+}
+
+} // namespace
+
+void appendJsonEscaped(std::pmr::string& out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    const char* cursor = text.data();
+    size_t remaining = text.size();
+    while (remaining > 0) {
+        size_t plain = plainPrefix(cursor, remaining);
+        out.append(cursor, plain);
+        cursor += plain;
+        remaining -= plain;
+        if (remaining == 0) {
+            break;
+        }
+        unsigned char c = static_cast<unsigned char>(*cursor);
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        default: {
+            char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+            out.append(escaped, sizeof(escaped));
+        }
+        }
+        cursor++;
+        remaining--;
+    }
+}
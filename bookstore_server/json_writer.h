@@ -0,0 +1,99 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <charconv>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+
+// Appends JSON-escaped text (without the surrounding quotes). Runs of plain
+// bytes are found 16 at a time with SSE2 and copied in one append.
+void appendJsonEscaped(std::pmr::string& out, std::string_view text);
+
+// Streaming JSON writer that appends straight into a caller-owned buffer,
+// usually HttpResponse::body in the connection arena. Commas and key/value
+// separators are tracked here, so callers only describe the structure:
+//
+//   JsonWriter json(response.body);
+//   json.beginObject();
+//   json.key("hits");
+//   json.number(cache.hits);
+//   json.endObject();
+//
+// Numbers go through std::to_chars: no locale, no allocation.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::pmr::string& out) : out(out) {}
+
+    void beginObject() { open('{'); }
+    void endObject() { close('}'); }
+    void beginArray() { open('['); }
+    void endArray() { close(']'); }
+
+    void key(std::string_view name) {
+        separate();
+        out.push_back('"');
+        appendJsonEscaped(out, name);
+        out += "\":";
+        afterKey = true;
+    }
+
+    void string(std::string_view value) {
+        separate();
+        out.push_back('"');
+        appendJsonEscaped(out, value);
+        out.push_back('"');
+    }
+
+    template <typename T>
+    void number(T value) {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "number() takes an integer or floating-point value");
+        separate();
+        char digits[32];
+        std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+    void boolean(bool value) {
+        separate();
+        out += value ? "true" : "false";
+    }
+
+    void null() {
+        separate();
+        out += "null";
+    }
+
+private:
+    void separate() {
+        if (afterKey) {
+            afterKey = false;
+            return;
+        }
+        uint64_t bit = uint64_t(1) << depth;
+        if (hasElements & bit) {
+            out.push_back(',');
+        }
+        hasElements |= bit;
+    }
+
+    void open(char bracket) {
+        separate();
+        out.push_back(bracket);
+        depth++;
+        hasElements &= ~(uint64_t(1) << depth);
+    }
+
+    void close(char bracket) {
+        out.push_back(bracket);
+        depth--;
+    }
+
+    std::pmr::string& out;
+    uint64_t hasElements = 0; // bit n: the container at depth n already has a member
+    int depth = 0;            // nesting is limited to 63 levels by hasElements
+    bool afterKey = false;
+};
+
+#endif // JSON_WRITER_H
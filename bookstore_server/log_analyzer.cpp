@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+// Summarizes server_requests.log files: per-resource hit counts, status mix
+// and latency percentiles.
+// Usage: log_analyzer [--threads N] [--top N] [--sort count|p99] <log>...
+
+struct MappedLog {
+    std::string path;
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+};
+
+struct ResourceStats {
+    uint64_t count = 0;
+    std::map<uint16_t, uint64_t> statuses;
+    std::unordered_map<uint64_t, uint64_t> latencies; // duration in ms -> hits
+};
+
+struct ThreadStats {
+    std::unordered_map<std::string_view, ResourceStats> resources;
+    uint64_t lines = 0;
+    uint64_t malformed = 0;
+};
+
+struct ResourceSummary {
+    std::string_view resource;
+    uint64_t count;
+    std::map<uint16_t, uint64_t> statuses;
+    double p50, p90, p99, max;
+};
+
+bool mapLog(const std::string& path, MappedLog& log) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "Error: Unable to open log file: " << path << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        std::cerr << "Error: Unable to stat log file: " << path << std::endl;
+        return false;
+    }
+    log.path = path;
+    log.size = static_cast<size_t>(st.st_size);
+    if (log.size > 0) {
+        void* mapped = mmap(nullptr, log.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            std::cerr << "Error: Unable to map log file: " << path << std::endl;
+            return false;
+        }
+        madvise(mapped, log.size, MADV_SEQUENTIAL);
+        log.data = static_cast<const char*>(mapped);
+    }
+    close(fd);
+    return true;
+}
+
+// Cuts a file into roughly equal pieces, moving each cut forward to the next newline.
+void splitLog(const MappedLog& log, size_t pieces, std::vector<Chunk>& chunks) {
+    const char* begin = log.data;
+    const char* fileEnd = log.data + log.size;
+    size_t step = std::max<size_t>(log.size / pieces, 1 << 20);
+    while (begin < fileEnd) {
+        const char* end = begin + std::min(step, static_cast<size_t>(fileEnd - begin));
+        if (end < fileEnd) {
+            const char* newline = static_cast<const char*>(memchr(end, '\n', fileEnd - end));
+            end = newline ? newline + 1 : fileEnd;
+        }
+        chunks.push_back({begin, end});
+        begin = end;
+    }
+}
+
+// Returns the field that ends at the next space and advances past it.
+inline bool nextField(const char*& cursor, const char* end, std::string_view& field) {
+    const char* space = static_cast<const char*>(memchr(cursor, ' ', end - cursor));
+    if (!space) {
+        return false;
+    }
+    field = std::string_view(cursor, space - cursor);
+    cursor = space + 1;
+    return true;
+}
+
+// Parses "[timestamp] METHOD resource status ip Nms". Method and resource may be empty.
+inline bool parseLine(const char* line, const char* end, ThreadStats& stats) {
+    if (line == end || *line != '[') {
+        return false;
+    }
+    const char* close = static_cast<const char*>(memchr(line, ']', end - line));
+    if (!close || end - close < 2 || close[1] != ' ') {
+        return false;
+    }
+    const char* cursor = close + 2;
+
+    std::string_view method, resource, status, ip;
+    if (!nextField(cursor, end, method) || !nextField(cursor, end, resource) ||
+        !nextField(cursor, end, status) || !nextField(cursor, end, ip)) {
+        return false;
+    }
+
+    uint16_t statusCode = 0;
+    for (char c : status) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        statusCode = static_cast<uint16_t>(statusCode * 10 + (c - '0'));
+    }
+
+    uint64_t duration = 0;
+    const char* digit = cursor;
+    while (digit < end && *digit >= '0' && *digit <= '9') {
+        duration = duration * 10 + static_cast<uint64_t>(*digit - '0');
+        digit++;
+    }
+    if (digit == cursor || end - digit < 2 || digit[0] != 'm' || digit[1] != 's') {
+        return false;
+    }
+
+    ResourceStats& resourceStats = stats.resources[resource];
+    resourceStats.count++;
+    resourceStats.statuses[statusCode]++;
+    resourceStats.latencies[duration]++;
+    return true;
+}
+
+void scanChunk(const Chunk& chunk, ThreadStats& stats) {
+    const char* line = chunk.begin;
+    while (line < chunk.end) {
+        const char* newline = static_cast<const char*>(memchr(line, '\n', chunk.end - line));
+        const char* lineEnd = newline ? newline : chunk.end;
+        if (lineEnd > line && lineEnd[-1] == '\r') {
+            lineEnd--;
+        }
+        if (lineEnd > line) {
+            stats.lines++;
+            if (!parseLine(line, lineEnd, stats)) {
+                stats.malformed++;
+            }
+        }
+        line = newline ? newline + 1 : chunk.end;
+    }
+}
+
+double percentileSeconds(const std::vector<std::pair<uint64_t, uint64_t>>& sorted, uint64_t total, double fraction) {
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (const auto& bucket : sorted) {
+        seen += bucket.second;
+        if (seen >= rank) {
+            return static_cast<double>(bucket.first) / 1000.0;
+        }
+    }
+    return sorted.empty() ? 0.0 : static_cast<double>(sorted.back().first) / 1000.0;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    size_t top = 50;
+    std::string sortBy = "count";
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threadCount = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--top" && i + 1 < argc) {
+            top = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--sort" && i + 1 < argc) {
+            sortBy = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--threads N] [--top N] [--sort count|p99] <log>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<MappedLog> logs(paths.size());
+    std::vector<Chunk> chunks;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!mapLog(paths[i], logs[i])) {
+            return 1;
+        }
+        splitLog(logs[i], threadCount * 4, chunks);
+    }
+
+    std::vector<ThreadStats> perThread(threadCount);
+    std::atomic<size_t> nextChunk{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; t++) {
+        workers.emplace_back([&, t] {
+            size_t index;
+            while ((index = nextChunk.fetch_add(1)) < chunks.size()) {
+                scanChunk(chunks[index], perThread[t]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Merge per-thread tables; keys stay views into the mapped files.
+    std::unordered_map<std::string_view, ResourceStats> merged;
+    std::map<uint16_t, uint64_t> statusTotals;
+    uint64_t lines = 0, malformed = 0;
+    for (ThreadStats& stats : perThread) {
+        lines += stats.lines;
+        malformed += stats.malformed;
+        for (auto& entry : stats.resources) {
+            ResourceStats& target = merged[entry.first];
+            target.count += entry.second.count;
+            for (const auto& status : entry.second.statuses) {
+                target.statuses[status.first] += status.second;
+                statusTotals[status.first] += status.second;
+            }
+            for (const auto& latency : entry.second.latencies) {
+                target.latencies[latency.first] += latency.second;
+            }
+        }
+    }
+
+    std::vector<ResourceSummary> summaries;
+    summaries.reserve(merged.size());
+    for (auto& entry : merged) {
+        std::vector<std::pair<uint64_t, uint64_t>> sorted(entry.second.latencies.begin(), entry.second.latencies.end());
+        std::sort(sorted.begin(), sorted.end());
+        uint64_t count = entry.second.count;
+        summaries.push_back({entry.first, count, entry.second.statuses,
+                             percentileSeconds(sorted, count, 0.50), percentileSeconds(sorted, count, 0.90),
+                             percentileSeconds(sorted, count, 0.99), static_cast<double>(sorted.back().first) / 1000.0});
+    }
+    std::sort(summaries.begin(), summaries.end(), [&sortBy](const ResourceSummary& a, const ResourceSummary& b) {
+        if (sortBy == "p99" && a.p99 != b.p99) {
+            return a.p99 > b.p99;
+        }
+        return a.count > b.count;
+    });
+
+    std::cout << "Lines: " << lines << ", malformed: " << malformed << ", resources: " << merged.size() << std::endl;
+    std::cout << "Status mix:";
+    for (const auto& status : statusTotals) {
+        std::cout << " " << status.first << "=" << status.second;
+    }
+    std::cout << std::endl << std::endl;
+
+    std::cout << std::left << std::setw(40) << "resource" << std::right << std::setw(10) << "count"
+              << std::setw(10) << "p50(s)" << std::setw(10) << "p90(s)" << std::setw(10) << "p99(s)"
+              << std::setw(10) << "max(s)" << "  statuses" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < summaries.size() && i < top; i++) {
+        const ResourceSummary& summary = summaries[i];
+        std::cout << std::left << std::setw(40) << (summary.resource.empty() ? std::string("-") : std::string(summary.resource))
+                  << std::right << std::setw(10) << summary.count << std::setw(10) << summary.p50
+                  << std::setw(10) << summary.p90 << std::setw(10) << summary.p99 << std::setw(10) << summary.max << " ";
+        for (const auto& status : summary.statuses) {
+            std::cout << " " << status.first << "=" << status.second;
+        }
+        std::cout << std::endl;
+    }
+
+    for (MappedLog& log : logs) {
+        if (log.data) {
+            munmap(const_cast<char*>(log.data), log.size);
+        }
+    }
+    return 0;
+}
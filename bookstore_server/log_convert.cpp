@@ -0,0 +1,34 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "access_log.h"
+
+// Converts a binary access log back to the server_requests.log text format.
+// Usage: log_convert <input.bin> [output.log]
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <input.bin> [output.log]" << std::endl;
+        return 1;
+    }
+
+    std::ofstream outFile;
+    if (argc == 3) {
+        outFile.open(argv[2], std::ios::app);
+        if (!outFile.is_open()) {
+            std::cerr << "Error: Unable to open output file: " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = argc == 3 ? outFile : std::cout;
+
+    bool ok = readBinaryAccessLog(argv[1], [&out](const AccessLogRecord& record) {
+        out << formatAccessLogLine(record) << '\n';
+    });
+    out.flush();
+
+    if (!ok) {
+        std::cerr << "Error: Malformed binary log: " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <netdb.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "access_log.h"
+
+// Re-issues the requests recorded in server_requests.log files (text or
+// binary) against a server, keeping the original order and, unless told
+// otherwise, the original timing. Reports per-resource latency divergence
+// between like quantities: the handler time the recorded log holds against the
+// handler time the target logged for the replay. Client latency (connect to
+// last byte) is shown beside them but never subtracted from handler time.
+// Usage: log_replay [--target host:port] [--speed X] [--connections N]
+//                   [--max-gap S] [--limit N] [--top N] [--timeout-ms N]
+//                   [--target-log PATH]... <log>...
+//   --speed 1 replays in real time, 10 ten times faster, 0 as fast as possible.
+//   --max-gap S shortens idle periods longer than S seconds (log time) to S.
+//   --target-log PATH is the target's access log (once per prefork worker
+//   file). Without it only client latency is reported. Other traffic the
+//   target serves during the replay is counted too, so replay against an
+//   otherwise idle server.
+
+using Clock = std::chrono::steady_clock;
+
+struct ReplayRequest {
+    int64_t timestamp;
+    std::string method;
+    std::string resource;
+    uint16_t status;
+    uint64_t durationMs;
+    int64_t scheduledNs = 0; // offset from the start of the replay
+};
+
+struct ReplayResult {
+    int status = 0;      // 0 when the request failed
+    double latencyMs = 0; // send to last byte
+    double lagMs = 0;     // how late the request started against its schedule
+};
+
+struct ResourceReport {
+    std::string resource;
+    std::vector<double> original;       // handler ms, recorded log
+    std::vector<double> replayedHandler; // handler ms, target log during the replay
+    std::vector<double> replayed;       // client ms, this run
+    uint64_t statusMismatches = 0;
+    uint64_t errors = 0;
+    double originalP50 = 0, originalP99 = 0, replayedP50 = 0, replayedP99 = 0;
+    double handlerP50 = 0, handlerP99 = 0;
+};
+
+bool isBinaryLog(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, "BSRL", 4) == 0;
+}
+
+// Parses "[YYYY-mm-dd HH:MM:SS] METHOD resource status ip Nms". Lines without a
+// method (requests the server could not parse) cannot be replayed.
+bool parseTextLine(const std::string& line, ReplayRequest& request) {
+    if (line.size() < 22 || line[0] != '[' || line[20] != ']') {
+        return false;
+    }
+    std::tm time = {};
+    if (!strptime(line.c_str() + 1, "%Y-%m-%d %H:%M:%S", &time)) {
+        return false;
+    }
+    time.tm_isdst = -1;
+    request.timestamp = static_cast<int64_t>(std::mktime(&time));
+
+    size_t methodStart = 22;
+    size_t methodEnd = line.find(' ', methodStart);
+    size_t resourceEnd = methodEnd == std::string::npos ? std::string::npos : line.find(' ', methodEnd + 1);
+    size_t statusEnd = resourceEnd == std::string::npos ? std::string::npos : line.find(' ', resourceEnd + 1);
+    size_t ipEnd = statusEnd == std::string::npos ? std::string::npos : line.find(' ', statusEnd + 1);
+    if (ipEnd == std::string::npos || methodEnd == methodStart || resourceEnd == methodEnd + 1) {
+        return false;
+    }
+    request.method = line.substr(methodStart, methodEnd - methodStart);
+    request.resource = line.substr(methodEnd + 1, resourceEnd - methodEnd - 1);
+    request.status = static_cast<uint16_t>(std::atoi(line.c_str() + resourceEnd + 1));
+    request.durationMs = std::strtoull(line.c_str() + ipEnd + 1, nullptr, 10);
+    return true;
+}
+
+bool loadLog(const std::string& path, std::vector<ReplayRequest>& requests, uint64_t& skipped) {
+    if (isBinaryLog(path)) {
+        return readBinaryAccessLog(path, [&](const AccessLogRecord& record) {
+            if (record.method.empty() || record.resource.empty()) {
+                skipped++;
+                return;
+            }
+            requests.push_back({record.timestamp, record.method, record.resource, record.status, record.durationMs});
+        });
+    }
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open log file: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        ReplayRequest request;
+        if (parseTextLine(line, request)) {
+            requests.push_back(std::move(request));
+        } else if (!line.empty()) {
+            skipped++;
+        }
+    }
+    return true;
+}
+
+// Log timestamps have one-second resolution, so requests within the same
+// second are spread evenly across it. Idle gaps longer than maxGapSeconds
+// (when positive) are shortened to it.
+void schedule(std::vector<ReplayRequest>& requests, double speed, double maxGapSeconds) {
+    if (speed <= 0 || requests.empty()) {
+        return;
+    }
+    double secondStart = 0;
+    size_t begin = 0;
+    while (begin < requests.size()) {
+        if (begin > 0) {
+            double gap = static_cast<double>(requests[begin].timestamp - requests[begin - 1].timestamp);
+            secondStart += maxGapSeconds > 0 ? std::min(gap, maxGapSeconds) : gap;
+        }
+        size_t end = begin;
+        while (end < requests.size() && requests[end].timestamp == requests[begin].timestamp) {
+            end++;
+        }
+        for (size_t i = begin; i < end; i++) {
+            double seconds = secondStart + static_cast<double>(i - begin) / static_cast<double>(end - begin);
+            requests[i].scheduledNs = static_cast<int64_t>(seconds * 1e9 / speed);
+        }
+        begin = end;
+    }
+}
+
+// One request per connection, as the server closes after every response.
+int issueRequest(const sockaddr_storage& address, socklen_t addressLength, const std::string& host,
+                 const ReplayRequest& request, int timeoutMs) {
+    int sock = socket(address.ss_family, SOCK_STREAM, 0);
+    if (sock == -1) {
+        return 0;
+    }
+    timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (connect(sock, reinterpret_cast<const sockaddr*>(&address), addressLength) == -1) {
+        close(sock);
+        return 0;
+    }
+
+    std::string message = request.method + " " + request.resource + " HTTP/1.1\r\nHost: " + host +
+                          "\r\nUser-Agent: log_replay\r\nConnection: close\r\n\r\n";
+    if (send(sock, message.data(), message.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(message.size())) {
+        close(sock);
+        return 0;
+    }
+
+    char buffer[16384];
+    char head[13] = {};
+    size_t headBytes = 0;
+    ssize_t received;
+    while ((received = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+        size_t copy = std::min(sizeof(head) - 1 - headBytes, static_cast<size_t>(received));
+        std::memcpy(head + headBytes, buffer, copy);
+        headBytes += copy;
+    }
+    close(sock);
+    if (received < 0 || headBytes < 12 || std::strncmp(head, "HTTP/1.", 7) != 0) {
+        return 0;
+    }
+    return std::atoi(head + 9);
+}
+
+// Collects the handler times the target logged since `since` (epoch seconds)
+// for replayed resources. The access log is written in batches, so the files
+// are re-read until they hold `expected` records or a few seconds pass.
+void loadTargetHandlerTimes(const std::vector<std::string>& paths, int64_t since, size_t expected,
+                            std::unordered_map<std::string, ResourceReport>& byResource) {
+    for (int attempt = 0; attempt < 25; attempt++) {
+        std::vector<ReplayRequest> logged;
+        uint64_t skipped = 0;
+        for (const std::string& path : paths) {
+            loadLog(path, logged, skipped);
+        }
+        for (auto& entry : byResource) {
+            entry.second.replayedHandler.clear();
+        }
+        size_t matched = 0;
+        for (const ReplayRequest& request : logged) {
+            auto it = request.timestamp >= since ? byResource.find(request.method + " " + request.resource) : byResource.end();
+            if (it != byResource.end()) {
+                it->second.replayedHandler.push_back(static_cast<double>(request.durationMs));
+                matched++;
+            }
+        }
+        if (matched >= expected) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    std::cerr << "Error: Target log is missing some replayed requests; handler times are partial." << std::endl;
+}
+
+double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+int main(int argc, char* argv[]) {
+    std::string target = "127.0.0.1:8080";
+    double speed = 1;
+    double maxGap = 0;
+    unsigned connections = 16;
+    size_t limit = 0;
+    size_t top = 50;
+    int timeoutMs = 5000;
+    std::vector<std::string> paths;
+    std::vector<std::string> targetLogs;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--target" && i + 1 < argc) {
+            target = argv[++i];
+        } else if (arg == "--speed" && i + 1 < argc) {
+            speed = std::stod(argv[++i]);
+        } else if (arg == "--max-gap" && i + 1 < argc) {
+            maxGap = std::stod(argv[++i]);
+        } else if (arg == "--connections" && i + 1 < argc) {
+            connections = static_cast<unsigned>(std::max(1, std::stoi(argv[++i])));
+        } else if (arg == "--limit" && i + 1 < argc) {
+            limit = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--top" && i + 1 < argc) {
+            top = static_cast<size_t>(std::stoul(argv[++i]));
+        } else if (arg == "--timeout-ms" && i + 1 < argc) {
+            timeoutMs = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--target-log" && i + 1 < argc) {
+            targetLogs.push_back(argv[++i]);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--target host:port] [--speed X] [--connections N]"
+                  << " [--max-gap S] [--limit N] [--top N] [--timeout-ms N] [--target-log PATH]... <log>..." << std::endl;
+        return 1;
+    }
+
+    size_t colon = target.rfind(':');
+    std::string host = target.substr(0, colon);
+    std::string port = colon == std::string::npos ? "8080" : target.substr(colon + 1);
+    addrinfo hints = {};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &resolved) != 0 || !resolved) {
+        std::cerr << "Error: Unable to resolve target: " << target << std::endl;
+        return 1;
+    }
+    sockaddr_storage address = {};
+    socklen_t addressLength = resolved->ai_addrlen;
+    std::memcpy(&address, resolved->ai_addr, resolved->ai_addrlen);
+    freeaddrinfo(resolved);
+
+    std::vector<ReplayRequest> requests;
+    uint64_t skipped = 0;
+    for (const std::string& path : paths) {
+        if (!loadLog(path, requests, skipped)) {
+            return 1;
+        }
+    }
+    // Several files (rotated logs, prefork workers) are merged into one timeline.
+    std::stable_sort(requests.begin(), requests.end(), [](const ReplayRequest& a, const ReplayRequest& b) {
+        return a.timestamp < b.timestamp;
+    });
+    if (limit > 0 && requests.size() > limit) {
+        requests.resize(limit);
+    }
+    if (requests.empty()) {
+        std::cerr << "Error: No replayable requests (" << skipped << " lines skipped)." << std::endl;
+        return 1;
+    }
+    schedule(requests, speed, maxGap);
+
+    std::cout << "Replaying " << requests.size() << " requests against " << target << " with "
+              << connections << " connections, speed ";
+    if (speed > 0) {
+        std::cout << speed << "x";
+    } else {
+        std::cout << "max";
+    }
+    std::cout << " (" << skipped << " lines skipped)." << std::endl;
+
+    std::vector<ReplayResult> results(requests.size());
+    std::atomic<size_t> next{0};
+    int64_t startedAt = static_cast<int64_t>(std::time(nullptr));
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < connections; t++) {
+        workers.emplace_back([&] {
+            size_t index;
+            while ((index = next.fetch_add(1)) < requests.size()) {
+                const ReplayRequest& request = requests[index];
+                Clock::time_point due = start + std::chrono::nanoseconds(request.scheduledNs);
+                std::this_thread::sleep_until(due);
+                Clock::time_point sent = Clock::now();
+                int status = issueRequest(address, addressLength, host, request, timeoutMs);
+                Clock::time_point done = Clock::now();
+                results[index].status = status;
+                results[index].latencyMs = std::chrono::duration<double, std::milli>(done - sent).count();
+                results[index].lagMs = std::chrono::duration<double, std::milli>(sent - due).count();
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::unordered_map<std::string, ResourceReport> byResource;
+    std::vector<double> lags;
+    uint64_t errors = 0, mismatches = 0;
+    size_t answered = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        ResourceReport& report = byResource[requests[i].method + " " + requests[i].resource];
+        report.original.push_back(static_cast<double>(requests[i].durationMs));
+        lags.push_back(results[i].lagMs);
+        if (results[i].status == 0) {
+            report.errors++;
+            errors++;
+            continue;
+        }
+        report.replayed.push_back(results[i].latencyMs);
+        answered++;
+        if (results[i].status != requests[i].status) {
+            report.statusMismatches++;
+            mismatches++;
+        }
+    }
+
+    bool haveHandler = !targetLogs.empty();
+    if (haveHandler) {
+        loadTargetHandlerTimes(targetLogs, startedAt, answered, byResource);
+    }
+
+    std::vector<ResourceReport> reports;
+    for (auto& entry : byResource) {
+        ResourceReport& report = entry.second;
+        report.resource = entry.first;
+        report.originalP50 = percentile(report.original, 0.50);
+        report.originalP99 = percentile(report.original, 0.99);
+        report.replayedP50 = percentile(report.replayed, 0.50);
+        report.replayedP99 = percentile(report.replayed, 0.99);
+        report.handlerP50 = percentile(report.replayedHandler, 0.50);
+        report.handlerP99 = percentile(report.replayedHandler, 0.99);
+        reports.push_back(std::move(report));
+    }
+    // Largest handler p99 divergence first; without target logs, slowest client p99 first.
+    std::sort(reports.begin(), reports.end(), [haveHandler](const ResourceReport& a, const ResourceReport& b) {
+        if (haveHandler) {
+            return std::fabs(a.handlerP99 - a.originalP99) > std::fabs(b.handlerP99 - b.originalP99);
+        }
+        return a.replayedP99 > b.replayedP99;
+    });
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Completed in " << elapsed << "s (" << static_cast<double>(requests.size()) / elapsed << " req/s), errors: "
+              << errors << ", status mismatches: " << mismatches << ", start lag p50/p99/max: "
+              << percentile(lags, 0.50) << "/" << percentile(lags, 0.99) << "/"
+              << *std::max_element(lags.begin(), lags.end()) << "ms" << std::endl << std::endl;
+
+    std::cout << "Latency in ms. log/run = server handler time recorded / during the replay (target log),"
+              << " d = run - log, client = replay end to end." << std::endl;
+    if (!haveHandler) {
+        std::cout << "No --target-log given: run and d columns are empty." << std::endl;
+    }
+    std::cout << std::left << std::setw(40) << "resource" << std::right << std::setw(8) << "count"
+              << std::setw(10) << "log p50" << std::setw(10) << "run p50" << std::setw(10) << "log p99"
+              << std::setw(10) << "run p99" << std::setw(10) << "d p99"
+              << std::setw(13) << "client p50" << std::setw(13) << "client p99" << std::setw(10) << "status!="
+              << std::setw(8) << "errors" << std::endl;
+    for (size_t i = 0; i < reports.size() && i < top; i++) {
+        const ResourceReport& report = reports[i];
+        std::cout << std::left << std::setw(40) << report.resource << std::right << std::setw(8) << report.original.size()
+                  << std::setw(10) << report.originalP50;
+        if (haveHandler) {
+            std::cout << std::setw(10) << report.handlerP50 << std::setw(10) << report.originalP99
+                      << std::setw(10) << report.handlerP99 << std::setw(10) << report.handlerP99 - report.originalP99;
+        } else {
+            std::cout << std::setw(10) << "-" << std::setw(10) << report.originalP99 << std::setw(10) << "-" << std::setw(10) << "-";
+        }
+        std::cout << std::setw(13) << report.replayedP50 << std::setw(13) << report.replayedP99
+                  << std::setw(10) << report.statusMismatches << std::setw(8) << report.errors << std::endl;
+    }
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,125 @@
+#ifndef MIME_TYPES_H
+#define MIME_TYPES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Extension -> MIME type lookup through a perfect hash generated at compile
+// time: one hash, one slot probe and one compare per request. Adding an
+// extension only means adding a row; the build fails if no seed fits.
+
+struct MimeEntry {
+    std::string_view extension;
+    const char* type;
+};
+
+constexpr MimeEntry mimeEntries[] = {
+    {"html", "text/html"},
+    {"htm", "text/html"},
+    {"css", "text/css"},
+    {"js", "application/javascript"},
+    {"mjs", "application/javascript"},
+    {"json", "application/json"},
+    {"xml", "application/xml"},
+    {"txt", "text/plain"},
+    {"csv", "text/csv"},
+    {"png", "image/png"},
+    {"jpg", "image/jpeg"},
+    {"jpeg", "image/jpeg"},
+    {"gif", "image/gif"},
+    {"svg", "image/svg+xml"},
+    {"ico", "image/x-icon"},
+    {"webp", "image/webp"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"pdf", "application/pdf"},
+    {"wasm", "application/wasm"},
+};
+
+constexpr size_t mimeEntryCount = sizeof(mimeEntries) / sizeof(mimeEntries[0]);
+constexpr size_t mimeTableSize = 64; // power of two, sparse enough for a seed to exist
+
+constexpr char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr uint32_t mimeHash(std::string_view extension, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : extension) {
+        hash = (hash ^ static_cast<unsigned char>(asciiLower(c))) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+constexpr bool mimeSeedWorks(uint32_t seed) {
+    bool used[mimeTableSize] = {};
+    for (size_t i = 0; i < mimeEntryCount; i++) {
+        size_t slot = mimeHash(mimeEntries[i].extension, seed) & (mimeTableSize - 1);
+        if (used[slot]) {
+            return false;
+        }
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t findMimeSeed() {
+    for (uint32_t seed = 0; seed < 100000; seed++) {
+        if (mimeSeedWorks(seed)) {
+            return seed;
+        }
+    }
+    return UINT32_MAX;
+}
+
+constexpr uint32_t mimeSeed = findMimeSeed();
+static_assert(mimeSeed != UINT32_MAX, "no perfect hash seed for mimeEntries; grow mimeTableSize");
+
+constexpr std::array<int8_t, mimeTableSize> buildMimeSlots() {
+    std::array<int8_t, mimeTableSize> slots{};
+    for (size_t i = 0; i < mimeTableSize; i++) {
+        slots[i] = -1;
+    }
+    for (size_t i = 0; i < mimeEntryCount; i++) {
+        slots[mimeHash(mimeEntries[i].extension, mimeSeed) & (mimeTableSize - 1)] = static_cast<int8_t>(i);
+    }
+    return slots;
+}
+
+constexpr std::array<int8_t, mimeTableSize> mimeSlots = buildMimeSlots();
+
+constexpr bool extensionEquals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Only the text after the final '.' of the last path segment counts, so
+// "/foo.html.bak" is not served as HTML.
+constexpr const char* mimeTypeForPath(std::string_view path, const char* fallback = "text/plain") {
+    size_t slash = path.rfind('/');
+    size_t dot = path.rfind('.');
+    if (dot == std::string_view::npos || (slash != std::string_view::npos && dot < slash)) {
+        return fallback;
+    }
+    std::string_view extension = path.substr(dot + 1);
+    int8_t index = mimeSlots[mimeHash(extension, mimeSeed) & (mimeTableSize - 1)];
+    if (index < 0 || !extensionEquals(mimeEntries[index].extension, extension)) {
+        return fallback;
+    }
+    return mimeEntries[index].type;
+}
+
+static_assert(std::string_view(mimeTypeForPath("/index.html")) == "text/html", "html lookup");
+static_assert(std::string_view(mimeTypeForPath("/foo.html.bak")) == "text/plain", "only the last extension counts");
+static_assert(std::string_view(mimeTypeForPath("/dir.css/readme")) == "text/plain", "extensions belong to the last segment");
+
+#endif // MIME_TYPES_H
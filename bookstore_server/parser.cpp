@@ -2,6 +2,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <stdexcept>
 #include "parser.h"
 
 std::map<std::string, std::string> parseConfig(const std::string& filename) {
@@ -25,3 +26,37 @@ std::map<std::string, std::string> parseConfig(const std::string& filename) {
 
     return config;
 }
+
+std::string getConfigValue(const std::map<std::string, std::string>& config, const std::string& key, const std::string& defaultValue) {
+    auto it = config.find(key);
+    if (it == config.end() || it->second.empty()) {
+        return defaultValue;
+    }
+    return it->second;
+}
+
+long long getConfigNumber(const std::map<std::string, std::string>& config, const std::string& key, long long defaultValue) {
+    auto it = config.find(key);
+    if (it == config.end() || it->second.empty()) {
+        return defaultValue;
+    }
+    try {
+        return std::stoll(it->second);
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid value for " << key << ": " << it->second << std::endl;
+        return defaultValue;
+    }
+}
+
+double getConfigDouble(const std::map<std::string, std::string>& config, const std::string& key, double defaultValue) {
+    auto it = config.find(key);
+    if (it == config.end() || it->second.empty()) {
+        return defaultValue;
+    }
+    try {
+        return std::stod(it->second);
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid value for " << key << ": " << it->second << std::endl;
+        return defaultValue;
+    }
+}
@@ -7,5 +7,9 @@
 
 std::map<std::string, std::string> parseConfig(const std::string& filename);
 
-#endif // PARSER_H
+// Lookup helpers for optional keys; missing or malformed values fall back to the default.
+std::string getConfigValue(const std::map<std::string, std::string>& config, const std::string& key, const std::string& defaultValue);
+long long getConfigNumber(const std::map<std::string, std::string>& config, const std::string& key, long long defaultValue);
+double getConfigDouble(const std::map<std::string, std::string>& config, const std::string& key, double defaultValue);
 
+#endif // PARSER_H
@@ -0,0 +1,139 @@
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "prefork.h"
+
+namespace {
+
+volatile sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+struct WorkerSlot {
+    pid_t pid = -1;
+    std::chrono::steady_clock::time_point startedAt;
+};
+
+pid_t spawnWorker(int index, const std::function<void(int)>& runWorker, pid_t supervisor) {
+    // Block stop signals across fork() so a SIGTERM aimed at a brand-new worker
+    // stays pending until the worker has dropped the supervisor's handler.
+    sigset_t stopSignals, previous;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGTERM);
+    sigaddset(&stopSignals, SIGINT);
+    sigprocmask(SIG_BLOCK, &stopSignals, &previous);
+    pid_t pid = fork();
+    if (pid == 0) {
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        sigprocmask(SIG_SETMASK, &previous, nullptr);
+        // Workers must not outlive the supervisor holding their slot.
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (getppid() != supervisor) {
+            _exit(1);
+        }
+        runWorker(index);
+        _exit(0);
+    }
+    sigprocmask(SIG_SETMASK, &previous, nullptr);
+    if (pid == -1) {
+        std::cerr << "Error: Unable to fork worker " << index << ": " << std::strerror(errno) << std::endl;
+    }
+    return pid;
+}
+
+} // namespace
+
+SharedCounters* createSharedCounters() {
+    void* mapped = mmap(nullptr, sizeof(SharedCounters), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Unable to map shared counters: " << std::strerror(errno) << std::endl;
+        return nullptr;
+    }
+    return new (mapped) SharedCounters();
+}
+
+int runPrefork(int workerCount, const std::function<void(int)>& runWorker, SharedCounters& counters) {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGTERM, &action, nullptr); // no SA_RESTART: waitpid must return on a signal
+    sigaction(SIGINT, &action, nullptr);
+
+    pid_t supervisor = getpid();
+    std::vector<WorkerSlot> slots(workerCount);
+    bool missing = false;
+    for (int i = 0; i < workerCount; i++) {
+        slots[i].pid = spawnWorker(i, runWorker, supervisor);
+        slots[i].startedAt = std::chrono::steady_clock::now();
+        if (slots[i].pid > 0) {
+            counters.workers++;
+        }
+        missing = missing || slots[i].pid == -1;
+    }
+
+    while (!stopRequested) {
+        if (missing) {
+            // A fork failed; retry it shortly instead of waiting for another worker to exit.
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+        int status;
+        pid_t pid = waitpid(-1, &status, missing ? WNOHANG : 0);
+        if (pid == -1) {
+            if (errno != EINTR && errno != ECHILD) {
+                std::cerr << "Error: waitpid failed: " << std::strerror(errno) << std::endl;
+                return 1;
+            }
+        }
+
+        missing = false;
+        for (int i = 0; i < workerCount && !stopRequested; i++) {
+            if (pid > 0 && slots[i].pid == pid) {
+                counters.workers--;
+                counters.active[i] = 0;
+                slots[i].pid = -1;
+                if (WIFSIGNALED(status)) {
+                    std::cerr << "Error: Worker " << i << " (pid " << pid << ") killed by signal " << WTERMSIG(status) << "; restarting." << std::endl;
+                } else {
+                    std::cerr << "Error: Worker " << i << " (pid " << pid << ") exited with status " << WEXITSTATUS(status) << "; restarting." << std::endl;
+                }
+                if (std::chrono::steady_clock::now() - slots[i].startedAt < std::chrono::seconds(1)) {
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                }
+                counters.workerRestarts++;
+            }
+            if (slots[i].pid == -1 && !stopRequested) {
+                slots[i].pid = spawnWorker(i, runWorker, supervisor);
+                slots[i].startedAt = std::chrono::steady_clock::now();
+                if (slots[i].pid > 0) {
+                    counters.workers++;
+                }
+            }
+            missing = missing || slots[i].pid == -1;
+        }
+    }
+
+    for (const WorkerSlot& slot : slots) {
+        if (slot.pid > 0) {
+            kill(slot.pid, SIGTERM);
+        }
+    }
+    for (const WorkerSlot& slot : slots) {
+        if (slot.pid > 0) {
+            waitpid(slot.pid, nullptr, 0);
+        }
+    }
+    counters.workers = 0;
+    return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef PREFORK_H
+#define PREFORK_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// Server-wide counters in an anonymous MAP_SHARED mapping. The mapping is
+// created before forking, so the supervisor and every worker see the same
+// atomics. In single-process mode the same struct is simply process-local.
+struct SharedCounters {
+    static const int maxWorkers = 256;
+
+    // Admitted and not yet closed, per worker slot (slot 0 in single-process
+    // mode). Kept per slot so a crashed worker's connections can be cleared.
+    std::atomic<uint64_t> active[maxWorkers] = {};
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> shed{0};
+    std::atomic<uint64_t> workerRestarts{0};
+    std::atomic<uint32_t> workers{0}; // live worker processes, 0 in single-process mode
+
+    uint64_t activeConnections() const {
+        uint64_t total = 0;
+        for (const auto& slot : active) {
+            total += slot.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared counters must not rely on process-local locks");
+
+// Returns nullptr (after printing an error) if the mapping fails.
+SharedCounters* createSharedCounters();
+
+// Forks workerCount (at most SharedCounters::maxWorkers) workers that share the already listening socket and
+// each run runWorker(index), which must not return while serving. Workers
+// that exit or crash are respawned in the same slot; a slot that dies within
+// a second of starting is respawned after a short delay. Returns when the
+// supervisor receives SIGTERM or SIGINT, after stopping the workers.
+int runPrefork(int workerCount, const std::function<void(int)>& runWorker, SharedCounters& counters);
+
+#endif // PREFORK_H
@@ -0,0 +1,634 @@
+#include <arpa/inet.h>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "parser.h"
+#include "proxy.h"
+
+namespace {
+
+const size_t relayChunk = 16 * 1024;
+const size_t maxHeadBytes = 64 * 1024; // request or upstream response header block
+
+std::deque<std::unique_ptr<Upstream>> upstreams;
+ProxyCache proxyCache;
+ProxyConfig activeConfig;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool containsIgnoreCase(std::string_view text, std::string_view needle) {
+    for (size_t i = 0; i + needle.size() <= text.size(); i++) {
+        if (equalsIgnoreCase(text.substr(i, needle.size()), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Hop-by-hop headers are for one connection only and are never forwarded.
+bool isHopByHop(std::string_view name) {
+    return equalsIgnoreCase(name, "Connection") || equalsIgnoreCase(name, "Keep-Alive") ||
+           equalsIgnoreCase(name, "Proxy-Connection") || equalsIgnoreCase(name, "TE") ||
+           equalsIgnoreCase(name, "Upgrade") || equalsIgnoreCase(name, "Trailer");
+}
+
+// Calls onHeader(name, value, line) for each header line of a block ending in a blank line.
+template <typename Fn>
+void forEachHeader(std::string_view block, Fn onHeader) {
+    while (!block.empty()) {
+        size_t end = block.find('\n');
+        std::string_view line = block.substr(0, end);
+        block = end == std::string_view::npos ? std::string_view() : block.substr(end + 1);
+        std::string_view trimmed = line;
+        if (!trimmed.empty() && trimmed.back() == '\r') {
+            trimmed.remove_suffix(1);
+        }
+        if (trimmed.empty()) {
+            return;
+        }
+        size_t colon = trimmed.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        std::string_view value = trimmed.substr(colon + 1);
+        size_t start = value.find_first_not_of(" \t");
+        onHeader(trimmed.substr(0, colon), start == std::string_view::npos ? std::string_view() : value.substr(start), trimmed);
+    }
+}
+
+// Finds where a chunked body ends while the bytes are relayed untouched.
+class ChunkedScanner {
+public:
+    // Consumes bytes and returns how many belong to the body; done() turns
+    // true once the terminating chunk and trailers have been seen.
+    size_t feed(const char* data, size_t size) {
+        size_t i = 0;
+        while (i < size && state != State::Done) {
+            char c = data[i];
+            switch (state) {
+            case State::Size:
+                if (std::isxdigit(static_cast<unsigned char>(c))) {
+                    chunkSize = chunkSize * 16 + static_cast<uint64_t>(std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::tolower(c) - 'a' + 10);
+                } else if (c == '\n') {
+                    state = chunkSize == 0 ? State::TrailerStart : State::Data;
+                } else if (c != '\r') {
+                    state = State::Extension;
+                }
+                i++;
+                break;
+            case State::Extension:
+                if (c == '\n') {
+                    state = chunkSize == 0 ? State::TrailerStart : State::Data;
+                }
+                i++;
+                break;
+            case State::Data: {
+                size_t take = static_cast<size_t>(std::min<uint64_t>(chunkSize, size - i));
+                chunkSize -= take;
+                i += take;
+                if (chunkSize == 0) {
+                    state = State::DataEnd;
+                }
+                break;
+            }
+            case State::DataEnd:
+                if (c == '\n') {
+                    state = State::Size;
+                }
+                i++;
+                break;
+            case State::TrailerStart:
+                state = c == '\n' ? State::Done : (c == '\r' ? State::TrailerStart : State::Trailer);
+                i++;
+                break;
+            case State::Trailer:
+                if (c == '\n') {
+                    state = State::TrailerStart;
+                }
+                i++;
+                break;
+            case State::Done:
+                break;
+            }
+        }
+        return i;
+    }
+
+    bool done() const { return state == State::Done; }
+
+private:
+    enum class State { Size, Extension, Data, DataEnd, TrailerStart, Trailer, Done };
+    State state = State::Size;
+    uint64_t chunkSize = 0;
+};
+
+// Only responses the upstream marks as shareable (max-age or s-maxage) are
+// cached, for at most proxy_cache_ttl_ms. Requests with Authorization or
+// Cookie and responses with Set-Cookie or Vary are never cached.
+std::chrono::milliseconds cacheLifetime(std::string_view cacheControl) {
+    if (containsIgnoreCase(cacheControl, "no-store") || containsIgnoreCase(cacheControl, "no-cache") ||
+        containsIgnoreCase(cacheControl, "private")) {
+        return std::chrono::milliseconds(0);
+    }
+    long long seconds = 0;
+    for (std::string_view directive : {std::string_view("s-maxage="), std::string_view("max-age=")}) {
+        for (size_t i = 0; i + directive.size() <= cacheControl.size(); i++) {
+            if (equalsIgnoreCase(cacheControl.substr(i, directive.size()), directive)) {
+                seconds = std::atoll(std::string(cacheControl.substr(i + directive.size())).c_str());
+                break;
+            }
+        }
+        if (seconds > 0) {
+            break;
+        }
+    }
+    return std::min(std::chrono::milliseconds(seconds * 1000), std::chrono::milliseconds(activeConfig.cacheTtlMs));
+}
+
+void clientIp(int clientSocket, char* ip, size_t size) {
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    ip[0] = '\0';
+    if (clientSocket >= 0 && getpeername(clientSocket, reinterpret_cast<sockaddr*>(&address), &length) == 0) {
+        inet_ntop(AF_INET, &address.sin_addr, ip, static_cast<socklen_t>(size));
+    }
+}
+
+void proxyRequest(RouteContext& context, Upstream& upstream) {
+    HttpResponse& response = context.response;
+    if (context.clientSocket < 0) {
+        setStatus(response, 502, "Bad Gateway", nullptr);
+        return;
+    }
+    if (!upstream.healthy()) {
+        setStatus(response, 503, "Service Unavailable", nullptr);
+        return;
+    }
+
+    // The server's first receive may end inside the header block (large
+    // cookies, headers split across segments); read on up to maxHeadBytes and
+    // parse the request again from the complete head.
+    HttpRequest& firstRead = context.request;
+    HttpRequest completeRequest;
+    std::pmr::string requestHead(&context.arena);
+    size_t headerEnd = firstRead.raw.find("\r\n\r\n");
+    if (headerEnd == std::string_view::npos) {
+        requestHead.assign(firstRead.raw.data(), firstRead.raw.size());
+        char chunk[4096];
+        while ((headerEnd = requestHead.find("\r\n\r\n")) == std::string::npos) {
+            if (requestHead.size() > maxHeadBytes) {
+                setStatus(response, 431, "Request Header Fields Too Large", nullptr);
+                return;
+            }
+            ssize_t received = recv(context.clientSocket, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                setStatus(response, 400, "Bad Request", nullptr);
+                return;
+            }
+            requestHead.append(chunk, static_cast<size_t>(received));
+        }
+        parseRequest(requestHead, completeRequest);
+    }
+    HttpRequest& request = requestHead.empty() ? firstRead : completeRequest;
+
+    // The cache is shared by all clients and keyed by resource only, so
+    // requests carrying credentials bypass it entirely.
+    bool cacheable = activeConfig.cacheTtlMs > 0 && request.method == "GET";
+    if (cacheable) {
+        forEachHeader(request.headers, [&](std::string_view name, std::string_view, std::string_view) {
+            if (equalsIgnoreCase(name, "Authorization") || equalsIgnoreCase(name, "Cookie")) {
+                cacheable = false;
+            }
+        });
+    }
+    std::string cacheKey;
+    if (cacheable) {
+        cacheKey = upstream.name() + std::string(request.resource);
+        int status = 0;
+        if (auto cached = proxyCache.get(cacheKey, status)) {
+            response.status = status;
+            response.streamed = true;
+            sendAll(context.clientSocket, cached->data(), cached->size());
+            return;
+        }
+    }
+
+    std::string_view initialBody = request.raw.substr(headerEnd + 4);
+
+    uint64_t contentLength = 0;
+    bool chunkedRequest = false;
+    std::pmr::string head(&context.arena);
+    head.reserve(request.raw.size() + 128);
+    head += request.method;
+    head += ' ';
+    head += request.resource;
+    head += " HTTP/1.1\r\n";
+    forEachHeader(request.headers, [&](std::string_view name, std::string_view value, std::string_view line) {
+        if (equalsIgnoreCase(name, "Content-Length")) {
+            contentLength = std::strtoull(std::string(value).c_str(), nullptr, 10);
+        } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+            chunkedRequest = true;
+        }
+        if (!isHopByHop(name)) {
+            head += line;
+            head += "\r\n";
+        }
+    });
+    if (chunkedRequest) {
+        setStatus(response, 411, "Length Required", nullptr);
+        return;
+    }
+    char ip[INET_ADDRSTRLEN];
+    clientIp(context.clientSocket, ip, sizeof(ip));
+    head += "X-Forwarded-For: ";
+    head += ip;
+    head += "\r\nConnection: keep-alive\r\n\r\n";
+    if (initialBody.size() > contentLength) {
+        initialBody = initialBody.substr(0, static_cast<size_t>(contentLength));
+    }
+
+    // A pooled socket may have been closed by the upstream since its last use;
+    // that only shows when sending, so retry once on a fresh connection as
+    // long as nothing has been read from the client yet.
+    int fd = -1;
+    for (int attempt = 0; attempt < 2 && fd == -1; attempt++) {
+        bool reused = false;
+        fd = upstream.acquire(reused);
+        if (fd == -1) {
+            break;
+        }
+        if (!sendAll(fd, head.data(), head.size()) || !sendAll(fd, initialBody.data(), initialBody.size())) {
+            upstream.release(fd, false);
+            fd = -1;
+            if (!reused) {
+                break;
+            }
+        }
+    }
+    if (fd == -1) {
+        setStatus(response, 502, "Bad Gateway", nullptr);
+        return;
+    }
+
+    // Stream the rest of the request body from the client.
+    std::unique_ptr<char[]> buffer(new char[relayChunk]);
+    uint64_t bodyLeft = contentLength - initialBody.size();
+    while (bodyLeft > 0) {
+        ssize_t received = recv(context.clientSocket, buffer.get(), static_cast<size_t>(std::min<uint64_t>(bodyLeft, relayChunk)), 0);
+        if (received <= 0 || !sendAll(fd, buffer.get(), static_cast<size_t>(received))) {
+            upstream.release(fd, false);
+            setStatus(response, 502, "Bad Gateway", nullptr);
+            return;
+        }
+        bodyLeft -= static_cast<uint64_t>(received);
+    }
+
+    // Read the upstream status line and headers.
+    std::string upstreamHead;
+    size_t upstreamHeadEnd = std::string::npos;
+    while (upstreamHeadEnd == std::string::npos) {
+        ssize_t received = recv(fd, buffer.get(), relayChunk, 0);
+        if (received <= 0 || upstreamHead.size() > maxHeadBytes) {
+            bool timedOut = received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            upstream.release(fd, false);
+            if (timedOut) {
+                setStatus(response, 504, "Gateway Timeout", nullptr);
+            } else {
+                setStatus(response, 502, "Bad Gateway", nullptr);
+            }
+            return;
+        }
+        upstreamHead.append(buffer.get(), static_cast<size_t>(received));
+        upstreamHeadEnd = upstreamHead.find("\r\n\r\n");
+    }
+    std::string pending = upstreamHead.substr(upstreamHeadEnd + 4);
+    upstreamHead.resize(upstreamHeadEnd + 4);
+
+    int status = upstreamHead.size() > 12 && upstreamHead.compare(0, 7, "HTTP/1.") == 0 ? std::atoi(upstreamHead.c_str() + 9) : 0;
+    if (status < 100) {
+        upstream.release(fd, false);
+        setStatus(response, 502, "Bad Gateway", nullptr);
+        return;
+    }
+
+    bool hasLength = false, chunked = false, upstreamCloses = false, personalized = false;
+    std::string_view cacheControl;
+    uint64_t responseLength = 0;
+    size_t firstLineEnd = upstreamHead.find("\r\n");
+    std::pmr::string clientHead(&context.arena);
+    clientHead.reserve(upstreamHead.size() + 32);
+    clientHead.append(upstreamHead, 0, firstLineEnd + 2);
+    forEachHeader(std::string_view(upstreamHead).substr(firstLineEnd + 2), [&](std::string_view name, std::string_view value, std::string_view line) {
+        if (equalsIgnoreCase(name, "Content-Length")) {
+            hasLength = true;
+            responseLength = std::strtoull(std::string(value).c_str(), nullptr, 10);
+        } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+            chunked = containsIgnoreCase(value, "chunked");
+        } else if (equalsIgnoreCase(name, "Connection")) {
+            upstreamCloses = containsIgnoreCase(value, "close");
+        } else if (equalsIgnoreCase(name, "Cache-Control")) {
+            cacheControl = value;
+        } else if (equalsIgnoreCase(name, "Set-Cookie") || equalsIgnoreCase(name, "Vary")) {
+            personalized = true; // the key has no room for per-client or varying representations
+        }
+        if (!isHopByHop(name)) {
+            clientHead += line;
+            clientHead += "\r\n";
+        }
+    });
+    clientHead += "Connection: close\r\n\r\n";
+    bool noBody = request.method == "HEAD" || status == 204 || status == 304 || (status >= 100 && status < 200);
+    std::chrono::milliseconds ttl = cacheable && status == 200 && !personalized ? cacheLifetime(cacheControl) : std::chrono::milliseconds(0);
+    cacheable = ttl.count() > 0;
+
+    response.status = status;
+    response.streamed = true;
+    std::string cached;
+    if (cacheable) {
+        cached.assign(clientHead.data(), clientHead.size());
+    }
+    bool clientOk = sendAll(context.clientSocket, clientHead.data(), clientHead.size());
+
+    // Relay the body as it arrives; the framing decides when the upstream
+    // connection is free again.
+    ChunkedScanner scanner;
+    uint64_t lengthLeft = responseLength;
+    bool complete = noBody || (hasLength && responseLength == 0);
+    auto relay = [&](const char* data, size_t size) {
+        if (chunked) {
+            size = scanner.feed(data, size);
+            complete = scanner.done();
+        } else if (hasLength) {
+            size = static_cast<size_t>(std::min<uint64_t>(size, lengthLeft));
+            lengthLeft -= size;
+            complete = lengthLeft == 0;
+        }
+        if (cacheable && cached.size() + size <= activeConfig.cacheMaxEntryBytes) {
+            cached.append(data, size);
+        } else {
+            cacheable = false;
+        }
+        clientOk = clientOk && sendAll(context.clientSocket, data, size);
+    };
+    if (!complete && !pending.empty()) {
+        relay(pending.data(), pending.size());
+    }
+    bool upstreamEof = false;
+    while (!complete) {
+        ssize_t received = recv(fd, buffer.get(), relayChunk, 0);
+        if (received <= 0) {
+            upstreamEof = received == 0;
+            break;
+        }
+        relay(buffer.get(), static_cast<size_t>(received));
+    }
+    // Without Content-Length or chunking the body ends when the upstream closes.
+    bool delimitedByClose = !chunked && !hasLength && !noBody;
+    if (delimitedByClose && upstreamEof) {
+        complete = true;
+    }
+
+    upstream.release(fd, complete && !delimitedByClose && !upstreamCloses);
+    if (cacheable && complete && clientOk) {
+        proxyCache.put(cacheKey, std::make_shared<const std::string>(std::move(cached)), status, ttl, activeConfig.cacheMaxBytes);
+    }
+}
+
+} // namespace
+
+ProxyConfig proxyConfigFromMap(const std::map<std::string, std::string>& config) {
+    ProxyConfig proxy;
+    std::string routes = getConfigValue(config, "proxy_routes", "");
+    size_t start = 0;
+    while (start < routes.size()) {
+        size_t end = routes.find(',', start);
+        std::string route = routes.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        size_t equals = route.find('=');
+        if (equals == std::string::npos || equals == 0 || route[0] != '/' || equals + 1 == route.size()) {
+            std::cerr << "Error: Invalid proxy route (expected /prefix/=host:port): " << route << std::endl;
+        } else {
+            proxy.routes.emplace_back(route.substr(0, equals), route.substr(equals + 1));
+        }
+        start = end == std::string::npos ? routes.size() : end + 1;
+    }
+    proxy.poolSize = static_cast<size_t>(getConfigNumber(config, "proxy_pool_size", static_cast<long long>(proxy.poolSize)));
+    proxy.timeoutMs = static_cast<int>(getConfigNumber(config, "proxy_timeout_ms", proxy.timeoutMs));
+    proxy.healthPath = getConfigValue(config, "proxy_health_path", proxy.healthPath);
+    proxy.healthIntervalMs = static_cast<int>(getConfigNumber(config, "proxy_health_interval_ms", proxy.healthIntervalMs));
+    proxy.cacheTtlMs = static_cast<int>(getConfigNumber(config, "proxy_cache_ttl_ms", proxy.cacheTtlMs));
+    proxy.cacheMaxEntryBytes = static_cast<size_t>(getConfigNumber(config, "proxy_cache_max_entry_bytes", static_cast<long long>(proxy.cacheMaxEntryBytes)));
+    proxy.cacheMaxBytes = static_cast<size_t>(getConfigNumber(config, "proxy_cache_max_bytes", static_cast<long long>(proxy.cacheMaxBytes)));
+    return proxy;
+}
+
+Upstream::Upstream(std::string upstreamHost, std::string upstreamPort, const ProxyConfig& proxyConfig)
+    : host(std::move(upstreamHost)), port(std::move(upstreamPort)), label(host + ":" + port), config(proxyConfig) {}
+
+Upstream::~Upstream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stopSignal.notify_all();
+    if (prober.joinable()) {
+        prober.join();
+    }
+    for (int fd : idle) {
+        close(fd);
+    }
+}
+
+int Upstream::connectNew() {
+    addrinfo hints = {};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* resolved = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &resolved) != 0 || !resolved) {
+        return -1;
+    }
+    int fd = socket(resolved->ai_family, SOCK_STREAM, 0);
+    if (fd != -1) {
+        timeval timeout{config.timeoutMs / 1000, (config.timeoutMs % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (connect(fd, resolved->ai_addr, resolved->ai_addrlen) == -1) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(resolved);
+    return fd;
+}
+
+int Upstream::acquire(bool& reused) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (!idle.empty()) {
+            int fd = idle.back();
+            idle.pop_back();
+            // An idle keep-alive socket must have nothing to read; EOF or stray bytes mean it is unusable.
+            char probe;
+            ssize_t peeked = recv(fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+            if (peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                reused = true;
+                return fd;
+            }
+            close(fd);
+        }
+    }
+    reused = false;
+    return connectNew();
+}
+
+void Upstream::release(int fd, bool reusable) {
+    if (reusable) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idle.size() < config.poolSize) {
+            idle.push_back(fd);
+            return;
+        }
+    }
+    close(fd);
+}
+
+bool Upstream::probe() {
+    int fd = connectNew();
+    if (fd == -1) {
+        return false;
+    }
+    std::string request = "GET " + config.healthPath + " HTTP/1.1\r\nHost: " + label + "\r\nConnection: close\r\n\r\n";
+    char reply[16] = {};
+    size_t got = 0;
+    if (sendAll(fd, request.data(), request.size())) {
+        ssize_t received;
+        while (got < sizeof(reply) - 1 && (received = recv(fd, reply + got, sizeof(reply) - 1 - got, 0)) > 0) {
+            got += static_cast<size_t>(received);
+        }
+    }
+    close(fd);
+    return got >= 12 && std::strncmp(reply, "HTTP/1.", 7) == 0 && reply[9] == '2';
+}
+
+void Upstream::startHealthChecks() {
+    if (config.healthIntervalMs <= 0 || prober.joinable()) {
+        return;
+    }
+    prober = std::thread([this] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            lock.unlock();
+            bool up = probe();
+            if (up != healthy()) {
+                std::cerr << (up ? "Upstream " : "Error: Upstream ") << label << (up ? " is healthy again." : " failed its health check.") << std::endl;
+            }
+            isHealthy.store(up, std::memory_order_relaxed);
+            lock.lock();
+            stopSignal.wait_for(lock, std::chrono::milliseconds(config.healthIntervalMs), [this] { return stopping; });
+        }
+    });
+}
+
+std::shared_ptr<const std::string> ProxyCache::get(const std::string& key, int& status) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    if (it->second.expires <= std::chrono::steady_clock::now()) {
+        bytes -= it->second.response->size();
+        insertionOrder.erase(it->second.age);
+        entries.erase(it);
+        return nullptr;
+    }
+    status = it->second.status;
+    return it->second.response;
+}
+
+void ProxyCache::put(const std::string& key, std::shared_ptr<const std::string> response, int status, std::chrono::milliseconds ttl, size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto existing = entries.find(key);
+    if (existing != entries.end()) {
+        bytes -= existing->second.response->size();
+        insertionOrder.erase(existing->second.age);
+        entries.erase(existing);
+    }
+    if (response->size() > maxBytes) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = insertionOrder.begin(); it != insertionOrder.end() && bytes + response->size() > maxBytes;) {
+        auto entry = entries.find(*it);
+        if (entry->second.expires <= now) {
+            bytes -= entry->second.response->size();
+            entries.erase(entry);
+            it = insertionOrder.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    while (bytes + response->size() > maxBytes && !insertionOrder.empty()) {
+        auto entry = entries.find(insertionOrder.front());
+        bytes -= entry->second.response->size();
+        entries.erase(entry);
+        insertionOrder.pop_front();
+    }
+    bytes += response->size();
+    insertionOrder.push_back(key);
+    entries.emplace(key, Entry{std::move(response), status, now + ttl, std::prev(insertionOrder.end())});
+}
+
+void registerProxyRoutes(Router& router, const ProxyConfig& config) {
+    activeConfig = config;
+    for (const auto& route : config.routes) {
+        size_t colon = route.second.rfind(':');
+        std::string host = colon == std::string::npos ? route.second : route.second.substr(0, colon);
+        std::string port = colon == std::string::npos ? "80" : route.second.substr(colon + 1);
+        // Routes to the same backend share its pool and health checks.
+        Upstream* upstream = nullptr;
+        for (auto& existing : upstreams) {
+            if (existing->name() == host + ":" + port) {
+                upstream = existing.get();
+            }
+        }
+        if (!upstream) {
+            upstreams.push_back(std::make_unique<Upstream>(host, port, config));
+            upstream = upstreams.back().get();
+        }
+        router.addPrefix("", route.first, [upstream](RouteContext& context) {
+            proxyRequest(context, *upstream);
+        });
+    }
+}
+
+void startProxyHealthChecks() {
+    for (auto& upstream : upstreams) {
+        upstream->startHealthChecks();
+    }
+}
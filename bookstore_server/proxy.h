@@ -0,0 +1,98 @@
+#ifndef PROXY_H
+#define PROXY_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "router.h"
+
+// Reverse-proxied path prefixes, e.g.
+//   proxy_routes=/api/=127.0.0.1:9000,/search/=10.0.0.5:8081
+// Requests are forwarded with their original path over pooled keep-alive
+// connections. Request bodies (Content-Length) and responses are relayed in
+// chunks as they arrive, never buffered whole.
+struct ProxyConfig {
+    std::vector<std::pair<std::string, std::string>> routes; // prefix -> host:port
+    size_t poolSize = 16;                                     // idle connections kept per upstream
+    int timeoutMs = 5000;
+    std::string healthPath = "/health";
+    int healthIntervalMs = 2000; // 0 disables health checks
+    int cacheTtlMs = 0;          // upper bound on max-age; 0 disables the response cache
+    size_t cacheMaxEntryBytes = 64 * 1024;
+    size_t cacheMaxBytes = 8 * 1024 * 1024;
+};
+
+ProxyConfig proxyConfigFromMap(const std::map<std::string, std::string>& config);
+
+// One backend: a pool of idle keep-alive sockets plus a health flag kept up
+// to date by a background prober.
+class Upstream {
+public:
+    Upstream(std::string host, std::string port, const ProxyConfig& config);
+    ~Upstream();
+    Upstream(const Upstream&) = delete;
+    Upstream& operator=(const Upstream&) = delete;
+
+    const std::string& name() const { return label; }
+    bool healthy() const { return isHealthy.load(std::memory_order_relaxed); }
+
+    // Returns an idle pooled socket when one is still open, else connects.
+    int acquire(bool& reused);
+    // Pools the socket if the exchange left it reusable, otherwise closes it.
+    void release(int fd, bool reusable);
+
+    void startHealthChecks();
+
+private:
+    int connectNew();
+    bool probe();
+
+    std::string host;
+    std::string port;
+    std::string label;
+    ProxyConfig config;
+    std::mutex mutex;
+    std::vector<int> idle;
+    std::atomic<bool> isHealthy{true};
+    std::thread prober;
+    std::condition_variable stopSignal;
+    bool stopping = false;
+};
+
+// Small GET 200 responses by upstream and resource, as the exact bytes sent
+// to the client. Only responses with max-age/s-maxage are stored. Bounded by total bytes; expired entries go first, then the oldest.
+class ProxyCache {
+public:
+    std::shared_ptr<const std::string> get(const std::string& key, int& status);
+    void put(const std::string& key, std::shared_ptr<const std::string> response, int status, std::chrono::milliseconds ttl, size_t maxBytes);
+
+private:
+    struct Entry {
+        std::shared_ptr<const std::string> response;
+        int status;
+        std::chrono::steady_clock::time_point expires;
+        std::list<std::string>::iterator age;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> insertionOrder; // oldest at the front
+    size_t bytes = 0;
+};
+
+// Adds a prefix route per configured upstream. Upstreams live for the process.
+void registerProxyRoutes(Router& router, const ProxyConfig& config);
+// Health probes run on threads, so prefork workers start them after forking.
+void startProxyHealthChecks();
+
+#endif // PROXY_H
@@ -0,0 +1,262 @@
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+#include "bundle.h"
+#include "json_writer.h"
+#include "mime_types.h"
+#include "request_handler.h"
+#include "trace.h"
+#include "websocket.h"
+
+namespace fs = std::filesystem;
+
+FileCache fileCache;
+
+namespace {
+
+std::string_view nextToken(std::string_view& rest) {
+    size_t start = rest.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos) {
+        rest = std::string_view();
+        return std::string_view();
+    }
+    size_t end = rest.find_first_of(" \t\r\n", start);
+    if (end == std::string_view::npos) {
+        end = rest.size();
+    }
+    std::string_view token = rest.substr(start, end - start);
+    rest.remove_prefix(end);
+    return token;
+}
+
+void appendNumber(std::pmr::string& out, unsigned long long value) {
+    char digits[20];
+    int len = 0;
+    do {
+        digits[len++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (len > 0) {
+        out.push_back(digits[--len]);
+    }
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "/" serves index.html whatever the query string. The resource (which the
+// access log records) is only rewritten when it carries no query.
+void rewriteIndexPath(HttpRequest& request) {
+    if (request.path != "/") {
+        return;
+    }
+    request.path = "/index.html";
+    if (request.query.empty()) {
+        request.resource = request.path;
+    }
+}
+
+} // namespace
+
+bool parseRequest(std::string_view raw, HttpRequest& request) {
+    std::string_view rest = raw;
+    request.raw = raw;
+    request.method = nextToken(rest);
+    request.resource = nextToken(rest);
+    request.protocol = nextToken(rest);
+    size_t queryStart = request.resource.find('?');
+    request.path = request.resource.substr(0, queryStart);
+    request.query = queryStart == std::string_view::npos ? std::string_view() : request.resource.substr(queryStart + 1);
+    size_t lineEnd = raw.find('\n');
+    request.headers = lineEnd == std::string_view::npos ? std::string_view() : raw.substr(lineEnd + 1);
+    return !request.method.empty();
+}
+
+std::string_view findHeader(const HttpRequest& request, std::string_view name) {
+    std::string_view rest = request.headers;
+    while (!rest.empty()) {
+        size_t lineEnd = rest.find('\n');
+        std::string_view line = rest.substr(0, lineEnd);
+        rest = lineEnd == std::string_view::npos ? std::string_view() : rest.substr(lineEnd + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            break; // end of headers
+        }
+        if (line.size() > name.size() && line[name.size()] == ':' && equalsIgnoreCase(line.substr(0, name.size()), name)) {
+            std::string_view value = line.substr(name.size() + 1);
+            size_t start = value.find_first_not_of(" \t");
+            return start == std::string_view::npos ? std::string_view() : value.substr(start);
+        }
+    }
+    return std::string_view();
+}
+
+const char* getMimeType(std::string_view filename) {
+    return mimeTypeForPath(filename);
+}
+
+void setStatus(HttpResponse& response, int status, const char* reason, const char* contentType) {
+    response.status = status;
+    response.headers = "HTTP/1.1 ";
+    appendNumber(response.headers, static_cast<unsigned long long>(status));
+    response.headers += " ";
+    response.headers += reason;
+    response.headers += "\r\n";
+    if (contentType) {
+        response.headers += "Content-Type: ";
+        response.headers += contentType;
+        response.headers += "\r\n";
+    }
+    response.headers += "\r\n";
+}
+
+void handleRequest(HttpRequest& request, const std::string& webRoot, Arena& arena, HttpResponse& response) {
+    rewriteIndexPath(request);
+    std::string_view resource = request.path;
+
+    std::pmr::string filePath(&arena);
+    filePath.reserve(webRoot.size() + resource.size());
+    filePath += webRoot;
+    filePath += resource;
+
+    FileStatus status;
+    response.file = fileCache.get(filePath, status);
+    traceMark(TracePhase::FsLookup);
+    if (status == FileStatus::Ok) {
+        setStatus(response, 200, "OK", getMimeType(filePath));
+    } else if (status == FileStatus::ReadError) {
+        setStatus(response, 500, "Internal Server Error", nullptr);
+    } else {
+        response.file = fileCache.get(webRoot + "/unavailable.html", status);
+        if (status == FileStatus::Ok) {
+            setStatus(response, 404, "Not Found", "text/html");
+        } else {
+            response.file = nullptr;
+            setStatus(response, 404, "Not Found", nullptr);
+        }
+    }
+}
+
+void handleBundleRequest(HttpRequest& request, const WebBundle& bundle, HttpResponse& response) {
+    rewriteIndexPath(request);
+    bool acceptGzip = findHeader(request, "Accept-Encoding").find("gzip") != std::string_view::npos;
+    BundleResponse found;
+    bool hit = bundle.find(request.path, acceptGzip, found);
+    traceMark(TracePhase::FsLookup);
+    if (hit) {
+        std::string_view ifNoneMatch = findHeader(request, "If-None-Match");
+        if (!found.etag.empty() && (ifNoneMatch == found.etag || ifNoneMatch == "*")) {
+            response.status = 304;
+            response.headers = "HTTP/1.1 304 Not Modified\r\nETag: ";
+            response.headers += found.etag;
+            response.headers += "\r\n\r\n";
+            return;
+        }
+        response.status = found.status;
+        response.raw = found.bytes;
+    } else if (bundle.notFound(acceptGzip, found)) {
+        response.status = found.status;
+        response.raw = found.bytes;
+    } else {
+        setStatus(response, 404, "Not Found", nullptr);
+    }
+}
+
+void listResources(const std::string& webRoot, HttpResponse& response) {
+    setStatus(response, 200, "OK", "application/json");
+    JsonWriter json(response.body);
+    json.beginObject();
+    json.key("resources");
+    json.beginArray();
+    for (const auto& entry : fs::directory_iterator(webRoot)) {
+        if (entry.is_regular_file()) {
+            json.string(entry.path().filename().native());
+        }
+    }
+    json.endArray();
+    json.endObject();
+}
+
+void serverStats(HttpResponse& response, const AdmissionStats& admission, const SharedCounters& counters,
+                 const WebSocketStats& websocket) {
+    setStatus(response, 200, "OK", "application/json");
+    FileCacheStats cache = fileCache.stats();
+    JsonWriter json(response.body);
+    json.beginObject();
+    // Server-wide totals, shared by all worker processes.
+    json.key("server");
+    json.beginObject();
+    json.key("pid");
+    json.number(getpid());
+    json.key("workers");
+    json.number(counters.workers.load());
+    json.key("worker_restarts");
+    json.number(counters.workerRestarts.load());
+    json.key("active_connections");
+    json.number(counters.activeConnections());
+    json.key("connections");
+    json.number(counters.connections.load());
+    json.key("requests");
+    json.number(counters.requests.load());
+    json.key("shed");
+    json.number(counters.shed.load());
+    json.endObject();
+    // The cache and admission controller below belong to this process.
+    json.key("cache");
+    json.beginObject();
+    json.key("hits");
+    json.number(cache.hits);
+    json.key("misses");
+    json.number(cache.misses);
+    json.key("coalesced");
+    json.number(cache.coalesced);
+    json.key("evictions");
+    json.number(cache.evictions);
+    json.key("entries");
+    json.number(cache.entries);
+    json.key("bytes");
+    json.number(cache.bytes);
+    json.endObject();
+    json.key("admission");
+    json.beginObject();
+    json.key("limit");
+    json.number(admission.limit);
+    json.key("inflight");
+    json.number(admission.inflight);
+    json.key("queued");
+    json.number(admission.queued);
+    json.key("admitted");
+    json.number(admission.admitted);
+    json.key("admitted_after_queueing");
+    json.number(admission.admittedAfterQueueing);
+    json.key("shed");
+    json.number(admission.shed);
+    json.key("queue_timeouts");
+    json.number(admission.queueTimeouts);
+    json.key("average_latency_us");
+    json.number(static_cast<unsigned long long>(admission.averageLatencyMs * 1000));
+    json.endObject();
+    json.key("websocket");
+    json.beginObject();
+    json.key("subscribers");
+    json.number(websocket.subscribers);
+    json.key("broadcasts");
+    json.number(websocket.broadcasts);
+    json.key("frames_queued");
+    json.number(websocket.framesQueued);
+    json.key("slow_clients_closed");
+    json.number(websocket.slowClientsClosed);
+    json.endObject();
+    json.endObject();
+}
@@ -0,0 +1,61 @@
+#ifndef REQUEST_HANDLER_H
+#define REQUEST_HANDLER_H
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include "admission.h"
+#include "arena.h"
+#include "bundle.h"
+#include "file_cache.h"
+#include "prefork.h"
+
+extern FileCache fileCache;
+
+// Views into the connection's receive buffer; nothing is copied while parsing.
+struct HttpRequest {
+    std::string_view method;
+    std::string_view resource;
+    std::string_view protocol;
+    std::string_view path;  // resource without the query string
+    std::string_view query;
+    std::string_view headers; // header lines after the request line, possibly truncated
+    std::string_view raw;     // everything received so far, including any body bytes
+};
+
+// Headers and generated bodies live in the connection arena. Static files are
+// sent straight from the cache entry instead of being appended to a string.
+struct HttpResponse {
+    explicit HttpResponse(Arena& arena) : headers(&arena), body(&arena) {}
+
+    int status = 200;
+    std::pmr::string headers; // status line and headers, including the blank line
+    std::pmr::string body;
+    std::shared_ptr<const CachedFile> file;
+    std::string_view raw; // complete preformatted response (bundle mode); sent instead of headers and body
+    bool streamed = false; // the handler already wrote the whole response to the client socket
+    // Runs on the connection thread after the response is sent and the
+    // connection has left admission control (protocol upgrades). It gets the
+    // client socket, which is closed when it returns.
+    std::function<void(int)> takeover;
+};
+
+struct WebSocketStats;
+
+bool parseRequest(std::string_view raw, HttpRequest& request);
+// Case-insensitive header lookup; returns the trimmed value or an empty view.
+std::string_view findHeader(const HttpRequest& request, std::string_view name);
+const char* getMimeType(std::string_view filename);
+void setStatus(HttpResponse& response, int status, const char* reason, const char* contentType);
+// Rewrites "/" to "/index.html" in request.resource, like the access log expects.
+void handleRequest(HttpRequest& request, const std::string& webRoot, Arena& arena, HttpResponse& response);
+// Serves request.path from the mmapped bundle: one hash probe, no syscalls.
+// Honors Accept-Encoding: gzip and If-None-Match.
+void handleBundleRequest(HttpRequest& request, const WebBundle& bundle, HttpResponse& response);
+void listResources(const std::string& webRoot, HttpResponse& response);
+void serverStats(HttpResponse& response, const AdmissionStats& admission, const SharedCounters& counters,
+                 const WebSocketStats& websocket);
+
+#endif // REQUEST_HANDLER_H
@@ -0,0 +1,142 @@
+#include "router.h"
+
+namespace {
+
+size_t countSegments(std::string_view path) {
+    size_t count = 0;
+    for (size_t i = 0; i < path.size(); i++) {
+        if (path[i] == '/' && i + 1 < path.size()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Yields the next segment of a "/a/b/c" path, advancing past it.
+std::string_view nextSegment(std::string_view& path) {
+    while (!path.empty() && path.front() == '/') {
+        path.remove_prefix(1);
+    }
+    size_t end = path.find('/');
+    std::string_view segment = path.substr(0, end);
+    path.remove_prefix(end == std::string_view::npos ? path.size() : end);
+    return segment;
+}
+
+} // namespace
+
+std::string_view RouteParams::get(std::string_view name) const {
+    for (int i = 0; i < count; i++) {
+        if (names[i] == name) {
+            return values[i];
+        }
+    }
+    return std::string_view();
+}
+
+std::string_view Router::intern(std::string_view text) {
+    storage.emplace_back(text);
+    return storage.back();
+}
+
+void Router::addExact(std::string_view method, std::string_view path, RouteHandler handler) {
+    exact[intern(path)].push_back({std::string(method), std::move(handler)});
+}
+
+void Router::addPrefix(std::string_view method, std::string_view prefix, RouteHandler handler) {
+    prefixes[intern(prefix)].push_back({std::string(method), std::move(handler)});
+}
+
+void Router::addPattern(std::string_view method, std::string_view pattern, RouteHandler handler) {
+    Pattern route{std::string(method), {}, std::move(handler)};
+    std::string_view rest = pattern;
+    while (!rest.empty()) {
+        std::string_view segment = nextSegment(rest);
+        if (!segment.empty()) {
+            route.segments.emplace_back(segment);
+        }
+    }
+    patterns[route.segments.size()].push_back(std::move(route));
+}
+
+void Router::setFallback(RouteHandler handler) {
+    fallback = std::move(handler);
+}
+
+const RouteHandler* Router::findMethod(const std::vector<Route>& routes, std::string_view method) {
+    for (const Route& route : routes) {
+        if (route.method.empty() || route.method == method) {
+            return &route.handler;
+        }
+    }
+    return nullptr;
+}
+
+const RouteHandler* Router::matchPattern(std::string_view method, std::string_view path, RouteParams& params) const {
+    auto candidates = patterns.find(countSegments(path));
+    if (candidates == patterns.end()) {
+        return nullptr;
+    }
+    for (const Pattern& pattern : candidates->second) {
+        if (!pattern.method.empty() && pattern.method != method) {
+            continue;
+        }
+        params.count = 0;
+        std::string_view rest = path;
+        bool matched = true;
+        for (const std::string& expected : pattern.segments) {
+            std::string_view segment = nextSegment(rest);
+            if (!expected.empty() && expected[0] == ':') {
+                if (segment.empty() || params.count == RouteParams::maxParams) {
+                    matched = false;
+                    break;
+                }
+                params.names[params.count] = std::string_view(expected).substr(1);
+                params.values[params.count] = segment;
+                params.count++;
+            } else if (segment != expected) {
+                matched = false;
+                break;
+            }
+        }
+        if (matched) {
+            return &pattern.handler;
+        }
+    }
+    params.count = 0;
+    return nullptr;
+}
+
+bool Router::dispatch(HttpRequest& request, HttpResponse& response, Arena& arena, int clientSocket) const {
+    RouteContext context{request, response, arena, {}, clientSocket};
+    std::string_view path = request.path;
+    const RouteHandler* handler = nullptr;
+
+    auto exactRoutes = exact.find(path);
+    if (exactRoutes != exact.end()) {
+        handler = findMethod(exactRoutes->second, request.method);
+    }
+    if (!handler && !patterns.empty()) {
+        handler = matchPattern(request.method, path, context.params);
+    }
+    if (!handler && !prefixes.empty()) {
+        // Try "/a/b/c", "/a/b/", "/a/", "/" -- the longest registered prefix wins.
+        for (size_t end = path.size(); end > 0 && !handler; end = path.rfind('/', end - 2) + 1) {
+            auto prefixRoutes = prefixes.find(path.substr(0, end));
+            if (prefixRoutes != prefixes.end()) {
+                handler = findMethod(prefixRoutes->second, request.method);
+            }
+            if (end == 1) {
+                break;
+            }
+        }
+    }
+    if (!handler && fallback) {
+        handler = &fallback;
+    }
+    if (!handler) {
+        return false;
+    }
+    (*handler)(context);
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "request_handler.h"
+
+struct RouteParams {
+    static const int maxParams = 4;
+    std::string_view names[maxParams];
+    std::string_view values[maxParams];
+    int count = 0;
+
+    std::string_view get(std::string_view name) const;
+};
+
+struct RouteContext {
+    HttpRequest& request;
+    HttpResponse& response;
+    Arena& arena;
+    RouteParams params;
+    int clientSocket; // for handlers that stream (set response.streamed); -1 when there is none
+};
+
+using RouteHandler = std::function<void(RouteContext&)>;
+
+// Dispatches on method and path (query string excluded).
+//   exact   "/stats"          -- hash lookup
+//   prefix  "/debug/"         -- hash lookup per '/' boundary of the path, longest first
+//   pattern "/books/:id"      -- compared segment by segment, only against patterns
+//                                with the same number of segments
+// An empty method matches any method. Lookups never allocate.
+class Router {
+public:
+    void addExact(std::string_view method, std::string_view path, RouteHandler handler);
+    void addPrefix(std::string_view method, std::string_view prefix, RouteHandler handler);
+    void addPattern(std::string_view method, std::string_view pattern, RouteHandler handler);
+    void setFallback(RouteHandler handler);
+
+    // Returns false when nothing (not even a fallback) handled the request.
+    bool dispatch(HttpRequest& request, HttpResponse& response, Arena& arena, int clientSocket = -1) const;
+
+private:
+    struct Route {
+        std::string method;
+        RouteHandler handler;
+    };
+    struct Pattern {
+        std::string method;
+        std::vector<std::string> segments; // ":name" marks a parameter
+        RouteHandler handler;
+    };
+    using RouteTable = std::unordered_map<std::string_view, std::vector<Route>>;
+
+    std::string_view intern(std::string_view text);
+    static const RouteHandler* findMethod(const std::vector<Route>& routes, std::string_view method);
+    const RouteHandler* matchPattern(std::string_view method, std::string_view path, RouteParams& params) const;
+
+    std::deque<std::string> storage; // owns the keys viewed by the tables
+    RouteTable exact;
+    RouteTable prefixes;
+    std::unordered_map<size_t, std::vector<Pattern>> patterns; // by segment count
+    RouteHandler fallback;
+};
+
+#endif // ROUTER_H
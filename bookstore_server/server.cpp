@@ -9,123 +9,200 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
-#include <filesystem>
-#include <iomanip>
-#include <sstream>
+#include <sys/uio.h>
+#include <cstddef>
+#include <string_view>
+#include <functional>
 #include "parser.h"
+#include "access_log.h"
+#include "request_handler.h"
+#include "cache_warmup.h"
+#include "trace.h"
+#include "admission.h"
+#include "router.h"
+#include "prefork.h"
+#include "affinity.h"
+#include "proxy.h"
+#include "websocket.h"
 
-namespace fs = std::filesystem;
-
-std::mutex requestMutex;
-int currentUsers = 0;
-
-std::string getMimeType(const std::string& filename) {
-    // Simple MIME type mapping based on file extension
-    if (filename.find(".html") != std::string::npos) return "text/html";
-    if (filename.find(".css") != std::string::npos) return "text/css";
-    if (filename.find(".js") != std::string::npos) return "application/javascript";
-    if (filename.find(".png") != std::string::npos) return "image/png";
-    if (filename.find(".jpg") != std::string::npos) return "image/jpeg";
-    return "text/plain";
-}
-
-std::string timePointToString(const std::chrono::system_clock::time_point& tp) {
-    std::time_t time = std::chrono::system_clock::to_time_t(tp);
-    std::tm tm = *std::localtime(&time);
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
-}
+AdmissionController admission;
+WebBundle webBundle;
+SharedCounters* sharedCounters = nullptr;
+int workerSlot = 0; // index into sharedCounters->active; 0 in single-process mode
 
 void logRequest(const std::string& method, const std::string& resource, const std::string& status, const std::string& ip, long long duration) {
-    std::lock_guard<std::mutex> lock(requestMutex);
-    std::ofstream logFile("server_requests.log", std::ios::app);
-    if (logFile.is_open()) {
-        logFile << "[" << timePointToString(std::chrono::system_clock::now()) << "] "
-                << method << " " << resource << " " << status << " " << ip << " " << duration << "ms" << std::endl;
-        logFile.close();
-    } else {
-        std::cerr << "Error: Unable to open log file." << std::endl;
-    }
+    // Formatting and file I/O happen on the access log's writer thread.
+    appendAccessLog(method, resource, status, ip, duration);
 }
 
-std::string handleRequest(const std::string& request, const std::string& webRoot, std::string& method, std::string& resource) {
-    std::string protocol;
-    std::istringstream requestStream(request);
-    requestStream >> method >> resource >> protocol;
-
-    if (resource == "/") {
-        resource = "/index.html";
+// Sends headers and body with one writev, resuming after partial writes.
+void sendResponse(int clientSocket, const HttpResponse& response) {
+    if (!response.raw.empty()) {
+        size_t offset = 0;
+        while (offset < response.raw.size()) {
+            ssize_t sent = send(clientSocket, response.raw.data() + offset, response.raw.size() - offset, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return;
+            }
+            offset += static_cast<size_t>(sent);
+        }
+        return;
     }
-
-    std::string filePath = webRoot + resource;
-
-    if (fs::exists(filePath)) {
-        std::ifstream file(filePath, std::ios::binary);
-        if (file.is_open()) {
-            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-            file.close();
-            return "HTTP/1.1 200 OK\r\nContent-Type: " + getMimeType(filePath) + "\r\n\r\n" + content;
-        } else {
-            return "HTTP/1.1 500 Internal Server Error\r\n\r\n";
+    std::string_view body = response.file ? std::string_view(response.file->content) : std::string_view(response.body);
+    iovec parts[2] = {
+        {const_cast<char*>(response.headers.data()), response.headers.size()},
+        {const_cast<char*>(body.data()), body.size()},
+    };
+    iovec* next = parts;
+    int remaining = body.empty() ? 1 : 2;
+    while (remaining > 0) {
+        ssize_t sent = writev(clientSocket, next, remaining);
+        if (sent <= 0) {
+            return;
         }
-    } else {
-        std::ifstream file(webRoot + "/unavailable.html", std::ios::binary);
-        if (file.is_open()) {
-            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-            file.close();
-            return "HTTP/1.1 404 Not Found\r\nContent-Type: text/html\r\n\r\n" + content;
-        } else {
-            return "HTTP/1.1 404 Not Found\r\n\r\n";
+        while (remaining > 0 && static_cast<size_t>(sent) >= next->iov_len) {
+            sent -= next->iov_len;
+            next++;
+            remaining--;
+        }
+        if (remaining > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + sent;
+            next->iov_len -= sent;
         }
     }
 }
 
-std::string listResources(const std::string& webRoot) {
-    std::string json = "{ \"resources\": [";
-    for (const auto& entry : fs::directory_iterator(webRoot)) {
-        if (fs::is_regular_file(entry)) {
-            json += "\"" + entry.path().filename().string() + "\",";
-        }
-    }
-    if (json.back() == ',') {
-        json.pop_back();
+void buildRoutes(Router& router, const std::string& webRoot) {
+    router.addExact("GET", "/resources", [webRoot](RouteContext& context) {
+        listResources(webRoot, context.response);
+    });
+    router.addExact("GET", "/stats", [](RouteContext& context) {
+        serverStats(context.response, admission.stats(), *sharedCounters, webSocketStats());
+    });
+    router.addExact("GET", "/debug/trace", [](RouteContext& context) {
+        setStatus(context.response, 200, "OK", "application/json");
+        dumpChromeTrace(context.response.body);
+    });
+    router.addExact("GET", "/debug/affinity", [](RouteContext& context) {
+        setStatus(context.response, 200, "OK", "application/json");
+        dumpAffinityReport(context.response.body);
+    });
+    router.addPrefix("HEAD", "/", [](RouteContext& context) {
+        setStatus(context.response, 200, "OK", nullptr); // Only headers for HEAD request
+    });
+    if (webBundle.isOpen()) {
+        router.setFallback([](RouteContext& context) {
+            handleBundleRequest(context.request, webBundle, context.response);
+        });
+    } else {
+        router.setFallback([webRoot](RouteContext& context) {
+            handleRequest(context.request, webRoot, context.arena, context.response);
+        });
     }
-    json += "] }";
-    return json;
 }
 
-void handleClient(int clientSocket, const std::string& webRoot) {
+void handleClient(int clientSocket, const Router& router, int64_t acceptedAt) {
+    pinWorkerThread();
+    if (!admission.acquire()) {
+        sharedCounters->shed++;
+        std::string response = "HTTP/1.1 503 Service Unavailable\r\n\r\n";
+        send(clientSocket, response.c_str(), response.size(), 0);
+        close(clientSocket);
+        return;
+    }
+    sharedCounters->connections++;
+    sharedCounters->active[workerSlot]++;
+
     char buffer[1024];
+    alignas(std::max_align_t) char arenaBuffer[4096];
+    Arena arena(arenaBuffer, sizeof(arenaBuffer));
+    int startCpu = affinityConnectionBegin();
+    std::function<void(int)> takeover;
+    // Only dispatch time feeds the limit: waiting on the client's recv or a slow send is not handler latency.
+    std::chrono::nanoseconds handlerLatency{0};
+
+    traceBegin(acceptedAt);
     int bytesRead = recv(clientSocket, buffer, sizeof(buffer), 0);
     if (bytesRead > 0) {
-        std::string request(buffer, bytesRead);
+        traceMark(TracePhase::FirstByte);
+        sharedCounters->requests++;
+        std::string_view raw(buffer, bytesRead);
         auto start = std::chrono::high_resolution_clock::now();
 
-        std::string method, resource;
-        std::string response;
-        if (request.find("GET /resources") == 0) {
-            response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + listResources(webRoot);
-        } else if (request.find("HEAD ") == 0) {
-            response = "HTTP/1.1 200 OK\r\n"; // Only headers for HEAD request
-        } else {
-            response = handleRequest(request, webRoot, method, resource);
-        }
+        HttpRequest request;
+        parseRequest(raw, request);
+        traceMark(TracePhase::Parsed);
+        HttpResponse response(arena);
+        router.dispatch(request, response, arena, clientSocket);
 
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        handlerLatency = end - start;
+        traceMark(TracePhase::BodyReady);
 
-        send(clientSocket, response.c_str(), response.size(), 0);
+        if (!response.streamed) {
+            sendResponse(clientSocket, response);
+        }
+        traceMark(TracePhase::LastByteSent);
+        traceEnd(request.method, request.resource, response.status);
         sockaddr_in clientAddr;
         socklen_t clientAddrLen = sizeof(clientAddr);
         getpeername(clientSocket, (sockaddr*)&clientAddr, &clientAddrLen);
-        std::string clientIP = inet_ntoa(clientAddr.sin_addr);
-        logRequest(method, resource, response.substr(9, 3), clientIP, duration);
+        char clientIP[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, sizeof(clientIP));
+        logRequest(std::string(request.method), std::string(request.resource), std::to_string(response.status), clientIP, duration);
+        takeover = std::move(response.takeover);
+    }
+    arena.reset();
+    affinityConnectionEnd(startCpu, arenaBuffer);
+    sharedCounters->active[workerSlot]--;
+    admission.release(handlerLatency);
+    // Long-lived upgraded connections must not hold an admission slot.
+    if (takeover) {
+        takeover(clientSocket);
     }
     close(clientSocket);
-    {
-        std::lock_guard<std::mutex> lock(requestMutex);
-        currentUsers--;
+}
+
+// Accept loop of one process; runs until the process is killed.
+void serveConnections(int serverSocket, const Router& router) {
+    pinAcceptorThread();
+    while (true) {
+        sockaddr_in clientAddr;
+        socklen_t clientAddrLen = sizeof(clientAddr);
+        int clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientAddrLen);
+        int64_t acceptedAt = traceNow();
+        if (clientSocket == -1) {
+            std::cerr << "Error accepting client connection." << std::endl;
+            continue;
+        }
+
+        // Admission (queueing or shedding with 503) happens on the connection thread.
+
+        std::thread clientThread(handleClient, clientSocket, std::cref(router), acceptedAt);
+        clientThread.detach();
+    }
+}
+
+// Starts this process's background threads. They do not survive fork(), so
+// in prefork mode every worker calls this after it has been forked. Call it
+// after configureAffinity: the threads inherit the caller's placement.
+void startProcessServices(const std::map<std::string, std::string>& config, const std::string& webRoot, int workers) {
+    AccessLogConfig logConfig = accessLogConfigFromMap(config);
+    if (workers > 0) {
+        // One file per worker slot: binary string ids and rotation are per writer.
+        logConfig.path += ".w" + std::to_string(workerSlot);
+    }
+    // Warmup reads the log as it was before this process started: in binary mode
+    // startAccessLog archives it first, so use the path it reports.
+    WarmupConfig warmup = warmupConfigFromMap(config);
+    std::string previousLog = startAccessLog(logConfig);
+    if (warmup.logPath.empty()) {
+        warmup.logPath = previousLog;
+    }
+    startProxyHealthChecks();
+    if (!webBundle.isOpen()) {
+        startCacheWarmup(warmup, webRoot);
     }
 }
 
@@ -133,7 +210,37 @@ int main() {
     std::map<std::string, std::string> config = parseConfig("server_config.cfg");
     int port = std::stoi(config["port"]);
     std::string webRoot = config["web_root"];
-    int maxUsers = std::stoi(config["max_users"]);
+    int workers = static_cast<int>(getConfigNumber(config, "workers", 0));
+    if (workers < 0 || workers > SharedCounters::maxWorkers) {
+        std::cerr << "Error: workers must be between 0 and " << SharedCounters::maxWorkers << "." << std::endl;
+        return 1;
+    }
+    sharedCounters = createSharedCounters();
+    if (!sharedCounters) {
+        return 1;
+    }
+    admission.configure(admissionConfigFromMap(config));
+    std::string bundlePath = getConfigValue(config, "bundle", "");
+    if (!bundlePath.empty()) {
+        if (!webBundle.open(bundlePath)) {
+            return 1;
+        }
+        std::cout << "Serving " << webBundle.entryCount() << " files from bundle " << bundlePath << "." << std::endl;
+    }
+    Router router;
+    buildRoutes(router, webRoot);
+    registerProxyRoutes(router, proxyConfigFromMap(config));
+    WebSocketConfig webSocketConfig = webSocketConfigFromMap(config);
+    if (workers > 0 && !webSocketConfig.path.empty()) {
+        // Subscribers live in one worker's memory: a publish would reach only that worker.
+        std::cerr << "Error: websocket_path requires workers=0." << std::endl;
+        return 1;
+    }
+    registerWebSocketRoutes(router, webSocketConfig);
+    fileCache.setLimits(getConfigNumber(config, "cache_max_bytes", 64 * 1024 * 1024),
+                        getConfigNumber(config, "cache_max_file_bytes", 1024 * 1024));
+    configureTracing(getConfigDouble(config, "trace_sample_rate", 0.0),
+                     getConfigNumber(config, "trace_buffer_size", 1024));
 
     int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (serverSocket == -1) {
@@ -158,32 +265,30 @@ int main() {
         return 1;
     }
 
-    std::cout << "Server started on port " << port << "." << std::endl;
-
-    while (true) {
-        sockaddr_in clientAddr;
-        socklen_t clientAddrLen = sizeof(clientAddr);
-        int clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientAddrLen);
-        if (clientSocket == -1) {
-            std::cerr << "Error accepting client connection." << std::endl;
-            continue;
-        }
+    if (!configureAffinity(affinityConfigFromMap(config), -1)) {
+        close(serverSocket);
+        return 1;
+    }
 
-        {
-            std::lock_guard<std::mutex> lock(requestMutex);
-            if (currentUsers >= maxUsers) {
-                std::string response = "HTTP/1.1 503 Service Unavailable\r\n\r\n";
-                send(clientSocket, response.c_str(), response.size(), 0);
-                close(clientSocket);
-                continue;
+    if (workers > 0) {
+        std::cout << "Server started on port " << port << " with " << workers << " worker processes." << std::endl;
+        int result = runPrefork(workers, [&](int index) {
+            workerSlot = index;
+            if (!configureAffinity(affinityConfigFromMap(config), index)) {
+                _exit(1);
             }
-            currentUsers++;
-        }
-
-        std::thread clientThread(handleClient, clientSocket, webRoot);
-        clientThread.detach();
+            startProcessServices(config, webRoot, workers);
+            serveConnections(serverSocket, router);
+        }, *sharedCounters);
+        close(serverSocket);
+        return result;
     }
 
+    std::cout << "Server started on port " << port << "." << std::endl;
+    startProcessServices(config, webRoot, workers);
+    serveConnections(serverSocket, router);
+
     close(serverSocket);
+    stopAccessLog();
     return 0;
 }
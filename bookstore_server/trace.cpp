@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "json_writer.h"
+#include "trace.h"
+
+namespace {
+
+const int phaseCount = static_cast<int>(TracePhase::Count);
+
+struct TraceRecord {
+    int64_t timestamps[phaseCount]; // steady clock ns, 0 when the phase was not reached
+    int status;
+    char method[8];
+    char resource[56];
+};
+
+struct TraceBuffer {
+    std::mutex mutex; // only contended while a dump is copying records
+    std::vector<TraceRecord> records;
+    size_t next = 0;
+    uint32_t tid = 0;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    std::vector<TraceBuffer*> idle; // buffers of exited threads, reused by new ones
+};
+
+TraceRegistry registry;
+std::atomic<uint64_t> sampleEvery{0};
+std::atomic<uint64_t> requestCounter{0};
+size_t bufferCapacity = 1024;
+
+// Connection threads are short-lived, so a thread borrows a buffer on its first
+// sampled request and hands it back (records intact) when it exits.
+struct BufferLease {
+    TraceBuffer* buffer = nullptr;
+
+    TraceBuffer* get() {
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            if (!registry.idle.empty()) {
+                buffer = registry.idle.back();
+                registry.idle.pop_back();
+            } else {
+                registry.buffers.push_back(std::make_unique<TraceBuffer>());
+                buffer = registry.buffers.back().get();
+                buffer->tid = static_cast<uint32_t>(registry.buffers.size());
+                buffer->records.reserve(bufferCapacity);
+            }
+        }
+        return buffer;
+    }
+
+    ~BufferLease() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.idle.push_back(buffer);
+        }
+    }
+};
+
+thread_local BufferLease lease;
+thread_local TraceRecord current;
+thread_local bool active = false;
+
+void copyLabel(char* out, size_t size, std::string_view value) {
+    size_t len = std::min(value.size(), size - 1);
+    std::memcpy(out, value.data(), len);
+    out[len] = '\0';
+}
+
+void appendEvent(JsonWriter& json, const char* name, int64_t begin, int64_t end, uint32_t tid, const TraceRecord& record) {
+    if (begin == 0 || end == 0 || end < begin) {
+        return;
+    }
+    json.beginObject();
+    json.key("name");
+    json.string(name);
+    json.key("ph");
+    json.string("X");
+    json.key("pid");
+    json.number(1);
+    json.key("tid");
+    json.number(tid);
+    json.key("ts");
+    json.number(static_cast<double>(begin) / 1000.0);
+    json.key("dur");
+    json.number(static_cast<double>(end - begin) / 1000.0);
+    json.key("args");
+    json.beginObject();
+    json.key("method");
+    json.string(record.method);
+    json.key("resource");
+    json.string(record.resource);
+    json.key("status");
+    json.number(record.status);
+    json.endObject();
+    json.endObject();
+}
+
+} // namespace
+
+void configureTracing(double sampleRate, size_t perThreadCapacity) {
+    bufferCapacity = std::max<size_t>(perThreadCapacity, 1);
+    sampleEvery = sampleRate > 0 ? static_cast<uint64_t>(std::max(1.0, std::round(1.0 / std::min(sampleRate, 1.0)))) : 0;
+}
+
+int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void traceBegin(int64_t acceptedAt) {
+    uint64_t every = sampleEvery.load(std::memory_order_relaxed);
+    if (every == 0 || requestCounter.fetch_add(1, std::memory_order_relaxed) % every != 0) {
+        active = false;
+        return;
+    }
+    std::memset(&current, 0, sizeof(current));
+    current.timestamps[static_cast<int>(TracePhase::Accepted)] = acceptedAt;
+    active = true;
+}
+
+void traceMark(TracePhase phase) {
+    if (active) {
+        current.timestamps[static_cast<int>(phase)] = traceNow();
+    }
+}
+
+void traceEnd(std::string_view method, std::string_view resource, int status) {
+    if (!active) {
+        return;
+    }
+    active = false;
+    current.status = status;
+    copyLabel(current.method, sizeof(current.method), method);
+    copyLabel(current.resource, sizeof(current.resource), resource);
+
+    TraceBuffer* buffer = lease.get();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    if (buffer->records.size() < bufferCapacity) {
+        buffer->records.push_back(current);
+    } else {
+        buffer->records[buffer->next] = current;
+        buffer->next = (buffer->next + 1) % bufferCapacity;
+    }
+}
+
+void dumpChromeTrace(std::pmr::string& out) {
+    std::vector<std::pair<uint32_t, TraceRecord>> records;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto& buffer : registry.buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            for (const TraceRecord& record : buffer->records) {
+                records.emplace_back(buffer->tid, record);
+            }
+        }
+    }
+
+    static const char* spanNames[phaseCount - 1] = {"accept to first byte", "parse", "fs lookup", "body ready", "send"};
+    out.reserve(out.size() + 64 + records.size() * phaseCount * 192);
+    JsonWriter json(out);
+    json.beginObject();
+    json.key("displayTimeUnit");
+    json.string("ms");
+    json.key("traceEvents");
+    json.beginArray();
+    for (const auto& entry : records) {
+        const TraceRecord& record = entry.second;
+        appendEvent(json, "request", record.timestamps[0], record.timestamps[phaseCount - 1], entry.first, record);
+        // Each span runs from the previous reached phase; skipped phases (e.g. no fs lookup for /stats) merge into the next.
+        int64_t previous = record.timestamps[0];
+        for (int phase = 1; phase < phaseCount; phase++) {
+            if (record.timestamps[phase] != 0) {
+                appendEvent(json, spanNames[phase - 1], previous, record.timestamps[phase], entry.first, record);
+                previous = record.timestamps[phase];
+            }
+        }
+    }
+    json.endArray();
+    json.endObject();
+}
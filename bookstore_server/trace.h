@@ -0,0 +1,34 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+// Per-request phase timestamps for sampled requests. Marks go to a
+// thread-local record, finished records to a per-thread ring buffer, so the
+// request path never takes a shared lock. Unsampled requests cost one
+// thread-local pointer check per mark.
+enum class TracePhase : int {
+    Accepted,
+    FirstByte,
+    Parsed,
+    FsLookup,
+    BodyReady,
+    LastByteSent,
+    Count
+};
+
+// sampleRate is the fraction of requests traced (0 disables tracing).
+void configureTracing(double sampleRate, size_t perThreadCapacity);
+int64_t traceNow();
+
+void traceBegin(int64_t acceptedAt);
+void traceMark(TracePhase phase);
+void traceEnd(std::string_view method, std::string_view resource, int status);
+
+// Appends every buffered trace to out as Chrome trace-event JSON, loadable in chrome://tracing or Perfetto.
+void dumpChromeTrace(std::pmr::string& out);
+
+#endif // TRACE_H
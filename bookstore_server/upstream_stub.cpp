@@ -0,0 +1,206 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+// Stand-in backend for proxy_routes tests and benchmarks. Speaks HTTP/1.1
+// with keep-alive and serves:
+//   GET  /health                 200, or 503 after POST /admin/health/down
+//   POST /admin/health/down|up   flips the health check result
+//   ANY  /api/echo               method, path, body size and X-Forwarded-For
+//   GET  /api/items/<id>         small JSON, Cache-Control: max-age=60
+//   GET  /api/private            small JSON, Cache-Control: private
+//   GET  /api/session            max-age=60 with a Set-Cookie header
+//   GET  /api/negotiated         max-age=60 with Vary: Accept-Language
+//   GET  /api/stream?bytes=N     N bytes, chunked, in 4 KiB chunks
+//   GET  /api/slow?ms=N          answers after N milliseconds
+//   GET  /stub/stats             connections accepted and requests served
+// Usage: upstream_stub [--port N] [--delay-ms N]
+
+std::atomic<bool> healthy{true};
+std::atomic<uint64_t> connectionCount{0};
+std::atomic<uint64_t> requestCount{0};
+int delayMs = 0;
+
+bool sendAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t sent = send(fd, data.data() + offset, data.size() - offset, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+std::string headerValue(const std::string& head, const std::string& name) {
+    std::string needle = "\r\n" + name + ":";
+    size_t start = head.find(needle);
+    if (start == std::string::npos) {
+        return "";
+    }
+    start += needle.size();
+    size_t end = head.find("\r\n", start);
+    size_t first = head.find_first_not_of(' ', start);
+    return first >= end ? "" : head.substr(first, end - first);
+}
+
+long queryNumber(const std::string& query, const std::string& name, long fallback) {
+    size_t start = query.find(name + "=");
+    return start == std::string::npos ? fallback : std::atol(query.c_str() + start + name.size() + 1);
+}
+
+bool respond(int fd, int status, const char* reason, const std::string& body, const std::string& extraHeaders = "") {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\nContent-Type: application/json\r\n" +
+                           extraHeaders + "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    return sendAll(fd, response);
+}
+
+bool streamChunked(int fd, long bytes) {
+    if (!sendAll(fd, "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nTransfer-Encoding: chunked\r\n\r\n")) {
+        return false;
+    }
+    std::string chunk(4096, 'x');
+    char size[16];
+    while (bytes > 0) {
+        long length = std::min<long>(bytes, static_cast<long>(chunk.size()));
+        std::snprintf(size, sizeof(size), "%lx\r\n", length);
+        if (!sendAll(fd, size) || !sendAll(fd, chunk.substr(0, static_cast<size_t>(length)) + "\r\n")) {
+            return false;
+        }
+        bytes -= length;
+    }
+    return sendAll(fd, "0\r\n\r\n");
+}
+
+// Returns false when the connection should be closed.
+bool handle(int fd, const std::string& head, const std::string& body) {
+    size_t methodEnd = head.find(' ');
+    size_t targetEnd = head.find(' ', methodEnd + 1);
+    std::string method = head.substr(0, methodEnd);
+    std::string target = head.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    size_t queryStart = target.find('?');
+    std::string path = target.substr(0, queryStart);
+    std::string query = queryStart == std::string::npos ? "" : target.substr(queryStart + 1);
+    requestCount++;
+    if (delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+
+    if (path == "/health") {
+        return healthy ? respond(fd, 200, "OK", "{\"status\":\"ok\"}") : respond(fd, 503, "Service Unavailable", "{\"status\":\"down\"}");
+    }
+    if (path == "/admin/health/down" || path == "/admin/health/up") {
+        healthy = path == "/admin/health/up";
+        return respond(fd, 200, "OK", "{}");
+    }
+    if (path == "/api/echo") {
+        return respond(fd, 200, "OK", "{\"method\":\"" + method + "\",\"path\":\"" + path + "\",\"body_bytes\":" +
+                                          std::to_string(body.size()) + ",\"forwarded_for\":\"" + headerValue(head, "X-Forwarded-For") + "\"}");
+    }
+    if (path.compare(0, 11, "/api/items/") == 0) {
+        return respond(fd, 200, "OK", "{\"id\":\"" + path.substr(11) + "\",\"title\":\"Book " + path.substr(11) + "\",\"stock\":" +
+                                          std::to_string(requestCount.load()) + "}", "Cache-Control: max-age=60\r\n");
+    }
+    if (path == "/api/private") {
+        return respond(fd, 200, "OK", "{\"user\":\"me\"}", "Cache-Control: private\r\n");
+    }
+    if (path == "/api/session") {
+        return respond(fd, 200, "OK", "{\"session\":" + std::to_string(requestCount.load()) + "}",
+                       "Cache-Control: max-age=60\r\nSet-Cookie: sid=" + std::to_string(requestCount.load()) + "\r\n");
+    }
+    if (path == "/api/negotiated") {
+        return respond(fd, 200, "OK", "{\"language\":\"" + headerValue(head, "Accept-Language") + "\"}",
+                       "Cache-Control: max-age=60\r\nVary: Accept-Language\r\n");
+    }
+    if (path == "/api/stream") {
+        return streamChunked(fd, queryNumber(query, "bytes", 1 << 20));
+    }
+    if (path == "/api/slow") {
+        std::this_thread::sleep_for(std::chrono::milliseconds(queryNumber(query, "ms", 100)));
+        return respond(fd, 200, "OK", "{\"slow\":true}");
+    }
+    if (path == "/stub/stats") {
+        return respond(fd, 200, "OK", "{\"connections\":" + std::to_string(connectionCount.load()) +
+                                          ",\"requests\":" + std::to_string(requestCount.load()) + "}");
+    }
+    return respond(fd, 404, "Not Found", "{}");
+}
+
+void serve(int fd) {
+    connectionCount++;
+    std::string buffered;
+    char chunk[16384];
+    while (true) {
+        size_t headEnd;
+        while ((headEnd = buffered.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                close(fd);
+                return;
+            }
+            buffered.append(chunk, static_cast<size_t>(received));
+        }
+        std::string head = buffered.substr(0, headEnd + 2);
+        size_t bodyLength = static_cast<size_t>(std::atol(headerValue(head, "Content-Length").c_str()));
+        while (buffered.size() < headEnd + 4 + bodyLength) {
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                close(fd);
+                return;
+            }
+            buffered.append(chunk, static_cast<size_t>(received));
+        }
+        std::string body = buffered.substr(headEnd + 4, bodyLength);
+        buffered.erase(0, headEnd + 4 + bodyLength);
+        bool keepAlive = headerValue(head, "Connection") != "close";
+        if (!handle(fd, head, body) || !keepAlive) {
+            close(fd);
+            return;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int port = 9000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if (arg == "--delay-ms" && i + 1 < argc) {
+            delayMs = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--port N] [--delay-ms N]" << std::endl;
+            return 1;
+        }
+    }
+
+    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (serverSocket == -1 || bind(serverSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 ||
+        listen(serverSocket, 128) == -1) {
+        std::cerr << "Error: Unable to listen on port " << port << "." << std::endl;
+        return 1;
+    }
+    std::cout << "Upstream stub listening on 127.0.0.1:" << port << "." << std::endl;
+
+    while (true) {
+        int clientSocket = accept(serverSocket, nullptr, nullptr);
+        if (clientSocket == -1) {
+            continue;
+        }
+        std::thread(serve, clientSocket).detach();
+    }
+}
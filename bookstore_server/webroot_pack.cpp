@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "bundle.h"
+#include "mime_types.h"
+
+namespace fs = std::filesystem;
+
+// Packs every regular file under a web root into one bundle for the server's
+// bundle= mode. unavailable.html, when present, also becomes the 404 response.
+// Usage: webroot_pack [--gzip] [--gzip-min-bytes N] <web_root> <output.bundle>
+
+struct PackedFile {
+    std::string path; // "/index.html"
+    int status = 200;
+    std::string headers;
+    std::string body;
+    std::string gzipHeaders;
+    std::string gzipBody;
+};
+
+std::string makeHeaders(int status, const char* reason, const char* contentType, size_t length,
+                        const std::string& etag, bool gzip) {
+    std::string headers = "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n";
+    headers += "Content-Type: ";
+    headers += contentType;
+    headers += "\r\nContent-Length: " + std::to_string(length) + "\r\n";
+    headers += "ETag: " + etag + "\r\n";
+    if (gzip) {
+        headers += "Content-Encoding: gzip\r\n";
+    }
+    headers += "Vary: Accept-Encoding\r\n\r\n";
+    return headers;
+}
+
+bool gzipCompress(const std::string& input, std::string& output) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    output.resize(deflateBound(&stream, input.size()));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+    int result = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+bool packFile(const fs::path& file, const std::string& urlPath, int status, const char* reason,
+              bool gzip, size_t gzipMinBytes, PackedFile& packed) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: Unable to read file: " << file.native() << std::endl;
+        return false;
+    }
+    packed.path = urlPath;
+    packed.status = status;
+    packed.body.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    const char* contentType = mimeTypeForPath(file.native());
+    std::string etag = bundleETag(packed.body);
+    packed.headers = makeHeaders(status, reason, contentType, packed.body.size(), etag, false);
+
+    // Only keep a gzip variant when it actually saves bytes. It is a different
+    // representation, so it gets its own ETag.
+    if (gzip && packed.body.size() >= gzipMinBytes) {
+        std::string compressed;
+        if (gzipCompress(packed.body, compressed) && compressed.size() < packed.body.size()) {
+            packed.gzipBody = std::move(compressed);
+            packed.gzipHeaders = makeHeaders(status, reason, contentType, packed.gzipBody.size(),
+                                             bundleETag(packed.gzipBody), true);
+        }
+    }
+    return true;
+}
+
+// Reads a written bundle back through WebBundle, as the server does, and checks
+// that every variant's ETag (the one a 304 would carry) is that of the body
+// served with it.
+bool verifyBundle(const std::string& path, const std::vector<PackedFile>& files) {
+    WebBundle bundle;
+    if (!bundle.open(path)) {
+        return false;
+    }
+    for (const PackedFile& file : files) {
+        for (bool acceptGzip : {false, true}) {
+            BundleResponse response;
+            size_t headEnd = std::string_view::npos;
+            if (bundle.find(file.path, acceptGzip, response)) {
+                headEnd = response.bytes.find("\r\n\r\n");
+            }
+            if (headEnd == std::string_view::npos || response.etag != bundleETag(response.bytes.substr(headEnd + 4))) {
+                std::cerr << "Error: Bundle ETag does not match the served body: " << file.path
+                          << (acceptGzip ? " (gzip)" : "") << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void writeAt(std::string& out, uint64_t offset, const T& value) {
+    std::memcpy(&out[offset], &value, sizeof(value));
+}
+
+int main(int argc, char* argv[]) {
+    bool gzip = false;
+    size_t gzipMinBytes = 256;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--gzip") {
+            gzip = true;
+        } else if (arg == "--gzip-min-bytes" && i + 1 < argc) {
+            gzipMinBytes = static_cast<size_t>(std::stoul(argv[++i]));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--gzip] [--gzip-min-bytes N] <web_root> <output.bundle>" << std::endl;
+        return 1;
+    }
+    fs::path webRoot = positional[0];
+    if (!fs::is_directory(webRoot)) {
+        std::cerr << "Error: Not a directory: " << webRoot.native() << std::endl;
+        return 1;
+    }
+
+    std::vector<PackedFile> files;
+    for (const auto& entry : fs::recursive_directory_iterator(webRoot)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::string urlPath = "/" + fs::relative(entry.path(), webRoot).generic_string();
+        files.emplace_back();
+        if (!packFile(entry.path(), urlPath, 200, "OK", gzip, gzipMinBytes, files.back())) {
+            return 1;
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const PackedFile& a, const PackedFile& b) { return a.path < b.path; });
+
+    PackedFile notFound;
+    bool hasNotFound = fs::is_regular_file(webRoot / "unavailable.html") &&
+                       packFile(webRoot / "unavailable.html", "", 404, "Not Found", gzip, gzipMinBytes, notFound);
+
+    // Index at most half full so probes stay short.
+    uint32_t slotCount = 16;
+    while (slotCount < files.size() * 2) {
+        slotCount *= 2;
+    }
+    uint32_t entryTotal = static_cast<uint32_t>(files.size()) + (hasNotFound ? 1 : 0);
+
+    BundleHeader header{};
+    std::memcpy(header.magic, bundleMagic, sizeof(bundleMagic));
+    header.version = bundleVersion;
+    header.entryCount = static_cast<uint32_t>(files.size());
+    header.slotCount = slotCount;
+    header.notFoundEntry = hasNotFound ? header.entryCount : bundleNoEntry;
+    header.entriesOffset = sizeof(BundleHeader);
+    header.slotsOffset = header.entriesOffset + static_cast<uint64_t>(entryTotal) * sizeof(BundleEntry);
+
+    std::string out(header.slotsOffset + static_cast<uint64_t>(slotCount) * sizeof(uint32_t), '\0');
+    std::vector<BundleEntry> entries(entryTotal);
+    std::vector<uint32_t> slots(slotCount, 0);
+
+    for (uint32_t i = 0; i < entryTotal; i++) {
+        const PackedFile& file = i < files.size() ? files[i] : notFound;
+        BundleEntry& entry = entries[i];
+        entry.pathHash = bundlePathHash(file.path);
+        entry.pathOffset = out.size();
+        entry.pathLength = static_cast<uint32_t>(file.path.size());
+        entry.status = static_cast<uint16_t>(file.status);
+        out += file.path;
+        if (i < files.size()) {
+            uint32_t slot = static_cast<uint32_t>(entry.pathHash & (slotCount - 1));
+            while (slots[slot] != 0) {
+                slot = (slot + 1) & (slotCount - 1);
+            }
+            slots[slot] = i + 1;
+        }
+    }
+    for (uint32_t i = 0; i < entryTotal; i++) {
+        const PackedFile& file = i < files.size() ? files[i] : notFound;
+        BundleEntry& entry = entries[i];
+        entry.responseOffset = out.size();
+        entry.headersLength = file.headers.size();
+        entry.bodyLength = file.body.size();
+        out += file.headers;
+        out += file.body;
+        if (!file.gzipBody.empty()) {
+            entry.gzipResponseOffset = out.size();
+            entry.gzipHeadersLength = file.gzipHeaders.size();
+            entry.gzipBodyLength = file.gzipBody.size();
+            out += file.gzipHeaders;
+            out += file.gzipBody;
+        }
+    }
+
+    writeAt(out, 0, header);
+    for (uint32_t i = 0; i < entryTotal; i++) {
+        writeAt(out, header.entriesOffset + static_cast<uint64_t>(i) * sizeof(BundleEntry), entries[i]);
+    }
+    std::memcpy(&out[header.slotsOffset], slots.data(), slots.size() * sizeof(uint32_t));
+
+    // A running server maps the bundle MAP_SHARED; rewriting it in place could
+    // SIGBUS it, so write a sibling file and rename it over the target.
+    std::string temporaryPath = positional[1] + ".tmp";
+    std::ofstream outFile(temporaryPath, std::ios::binary | std::ios::trunc);
+    bool written = outFile.is_open() && outFile.write(out.data(), static_cast<std::streamsize>(out.size()));
+    outFile.close();
+    std::error_code ec;
+    if (written && !outFile.fail() && !verifyBundle(temporaryPath, files)) {
+        fs::remove(temporaryPath, ec);
+        return 1;
+    }
+    if (written && !outFile.fail()) {
+        fs::rename(temporaryPath, positional[1], ec);
+    }
+    if (!written || outFile.fail() || ec) {
+        std::cerr << "Error: Unable to write bundle: " << positional[1] << std::endl;
+        fs::remove(temporaryPath, ec);
+        return 1;
+    }
+
+    size_t gzipped = std::count_if(files.begin(), files.end(), [](const PackedFile& f) { return !f.gzipBody.empty(); });
+    std::cout << "Packed " << files.size() << " files (" << gzipped << " with gzip"
+              << (hasNotFound ? ", plus 404 page" : "") << ") into " << positional[1]
+              << " (" << out.size() << " bytes)." << std::endl;
+    return 0;
+}
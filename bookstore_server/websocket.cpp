@@ -0,0 +1,545 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+#include "json_writer.h"
+#include "parser.h"
+#include "websocket.h"
+
+namespace {
+
+const uint8_t opText = 0x1;
+const uint8_t opBinary = 0x2;
+const uint8_t opClose = 0x8;
+const uint8_t opPing = 0x9;
+const uint8_t opPong = 0xA;
+
+const uint16_t closeNormal = 1000;
+const uint16_t closeProtocolError = 1002;
+const uint16_t closePolicyViolation = 1008;
+const uint16_t closeTooBig = 1009;
+
+const int closeDrainTimeoutMs = 5000;
+
+// One upgraded connection. Broadcasts append references to shared frames;
+// the session thread sends from them and pops them once fully written.
+struct Subscriber {
+    int wakeFd = -1; // eventfd, written after every push
+    std::mutex mutex;
+    std::deque<std::shared_ptr<const std::string>> queue;
+    size_t queuedBytes = 0;
+    bool accepting = true; // cleared once the session starts closing
+    bool overflowed = false;
+};
+
+WebSocketConfig activeConfig;
+std::mutex hubMutex;
+std::vector<Subscriber*> subscribers;
+std::atomic<uint64_t> broadcastCount{0};
+std::atomic<uint64_t> framesQueued{0};
+std::atomic<uint64_t> slowClientsClosed{0};
+
+bool containsIgnoreCase(std::string_view text, std::string_view needle) {
+    for (size_t i = 0; i + needle.size() <= text.size(); i++) {
+        size_t j = 0;
+        while (j < needle.size() &&
+               std::tolower(static_cast<unsigned char>(text[i + j])) == std::tolower(static_cast<unsigned char>(needle[j]))) {
+            j++;
+        }
+        if (j == needle.size()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t rotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+void wake(Subscriber& subscriber) {
+    uint64_t one = 1;
+    ssize_t written = write(subscriber.wakeFd, &one, sizeof(one));
+    (void)written; // a saturated counter still wakes the session
+}
+
+// Queues a frame for one subscriber. A subscriber that would go over
+// maxQueueBytes is flagged instead, and its session closes it.
+bool enqueue(Subscriber& subscriber, const std::shared_ptr<const std::string>& frame) {
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(subscriber.mutex);
+        if (!subscriber.accepting) {
+            return false;
+        }
+        if (subscriber.queuedBytes + frame->size() > activeConfig.maxQueueBytes) {
+            subscriber.accepting = false;
+            subscriber.overflowed = true;
+        } else {
+            subscriber.queue.push_back(frame);
+            subscriber.queuedBytes += frame->size();
+            queued = true;
+        }
+    }
+    wake(subscriber);
+    return queued;
+}
+
+std::shared_ptr<const std::string> closeFrame(uint16_t code) {
+    char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xff)};
+    return std::make_shared<const std::string>(encodeWebSocketFrame(opClose, std::string_view(payload, 2)));
+}
+
+// Stops accepting broadcasts and queues a close frame after whatever frame is
+// partly written; everything else still queued is dropped.
+void beginClose(Subscriber& subscriber, uint16_t code, bool frontStarted) {
+    std::lock_guard<std::mutex> lock(subscriber.mutex);
+    subscriber.accepting = false;
+    while (subscriber.queue.size() > (frontStarted ? 1u : 0u)) {
+        subscriber.queuedBytes -= subscriber.queue.back()->size();
+        subscriber.queue.pop_back();
+    }
+    auto frame = closeFrame(code);
+    subscriber.queue.push_back(frame);
+    subscriber.queuedBytes += frame->size();
+}
+
+enum class ParseResult { NeedMore, Frame, Error };
+
+struct ClientFrame {
+    bool fin;
+    uint8_t opcode;
+    std::string_view payload; // unmasked in place
+    size_t length;            // bytes consumed from the input
+};
+
+ParseResult parseClientFrame(std::string& input, size_t offset, ClientFrame& frame, uint16_t& errorCode) {
+    size_t available = input.size() - offset;
+    if (available < 2) {
+        return ParseResult::NeedMore;
+    }
+    auto* bytes = reinterpret_cast<unsigned char*>(&input[offset]);
+    frame.fin = bytes[0] & 0x80;
+    frame.opcode = bytes[0] & 0x0f;
+    bool masked = bytes[1] & 0x80;
+    uint64_t payloadLength = bytes[1] & 0x7f;
+    size_t headerLength = 2;
+    if ((bytes[0] & 0x70) != 0 || !masked) {
+        errorCode = closeProtocolError; // no extensions negotiated; clients must mask
+        return ParseResult::Error;
+    }
+    bool control = frame.opcode & 0x8;
+    if ((frame.opcode > opBinary && !control) || frame.opcode > opPong || (control && (!frame.fin || payloadLength > 125))) {
+        errorCode = closeProtocolError;
+        return ParseResult::Error;
+    }
+    if (payloadLength == 126) {
+        if (available < 4) {
+            return ParseResult::NeedMore;
+        }
+        payloadLength = (static_cast<uint64_t>(bytes[2]) << 8) | bytes[3];
+        headerLength = 4;
+    } else if (payloadLength == 127) {
+        if (available < 10) {
+            return ParseResult::NeedMore;
+        }
+        payloadLength = 0;
+        for (int i = 0; i < 8; i++) {
+            payloadLength = (payloadLength << 8) | bytes[2 + i];
+        }
+        headerLength = 10;
+    }
+    if (payloadLength > activeConfig.maxFrameBytes) {
+        errorCode = closeTooBig;
+        return ParseResult::Error;
+    }
+    if (available < headerLength + 4 + payloadLength) {
+        return ParseResult::NeedMore;
+    }
+    const unsigned char* mask = bytes + headerLength;
+    unsigned char* payload = bytes + headerLength + 4;
+    for (uint64_t i = 0; i < payloadLength; i++) {
+        payload[i] ^= mask[i & 3];
+    }
+    frame.payload = std::string_view(reinterpret_cast<char*>(payload), static_cast<size_t>(payloadLength));
+    frame.length = headerLength + 4 + static_cast<size_t>(payloadLength);
+    return ParseResult::Frame;
+}
+
+// Runs on the connection thread after the 101 has been sent; returns when
+// the connection is finished. The caller closes the socket.
+void runSession(int clientSocket) {
+    Subscriber subscriber;
+    subscriber.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (subscriber.wakeFd == -1) {
+        std::cerr << "Error: Unable to create eventfd for WebSocket session." << std::endl;
+        return;
+    }
+    fcntl(clientSocket, F_SETFL, fcntl(clientSocket, F_GETFL) | O_NONBLOCK);
+    {
+        std::lock_guard<std::mutex> lock(hubMutex);
+        subscribers.push_back(&subscriber);
+    }
+
+    std::string input;
+    size_t sentOffset = 0; // into the front queued frame
+    bool closing = false;  // a close frame is queued; end once it is written
+    bool peerClosed = false;
+    char buffer[4096];
+    while (true) {
+        std::shared_ptr<const std::string> front;
+        bool overflowed;
+        {
+            std::lock_guard<std::mutex> lock(subscriber.mutex);
+            if (!subscriber.queue.empty()) {
+                front = subscriber.queue.front();
+            }
+            overflowed = subscriber.overflowed;
+            subscriber.overflowed = false;
+        }
+        if (overflowed) {
+            slowClientsClosed++;
+            beginClose(subscriber, closePolicyViolation, sentOffset > 0);
+            closing = true;
+            continue;
+        }
+
+        // Write as much of the queue as the socket takes, straight from the shared frames.
+        bool blocked = false;
+        while (front) {
+            ssize_t sent = send(clientSocket, front->data() + sentOffset, front->size() - sentOffset, MSG_NOSIGNAL);
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                blocked = true;
+                break;
+            }
+            if (sent <= 0) {
+                peerClosed = true;
+                break;
+            }
+            sentOffset += static_cast<size_t>(sent);
+            if (sentOffset < front->size()) {
+                continue;
+            }
+            sentOffset = 0;
+            std::lock_guard<std::mutex> lock(subscriber.mutex);
+            subscriber.queuedBytes -= front->size();
+            subscriber.queue.pop_front();
+            front = subscriber.queue.empty() ? nullptr : subscriber.queue.front();
+        }
+        if (peerClosed || (closing && !front)) {
+            break;
+        }
+
+        pollfd fds[2] = {
+            {clientSocket, static_cast<short>((closing ? 0 : POLLIN) | (blocked ? POLLOUT : 0)), 0},
+            {subscriber.wakeFd, POLLIN, 0},
+        };
+        int ready = poll(fds, 2, closing ? closeDrainTimeoutMs : -1);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (ready == 0) {
+            break; // the client stopped reading while we were closing
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t count;
+            ssize_t drained = read(subscriber.wakeFd, &count, sizeof(count));
+            (void)drained;
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP)) {
+            break;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        ssize_t received = recv(clientSocket, buffer, sizeof(buffer), 0);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            break;
+        }
+        if (received < 0) {
+            continue;
+        }
+        input.append(buffer, static_cast<size_t>(received));
+        size_t consumed = 0;
+        ClientFrame frame;
+        uint16_t errorCode = closeNormal;
+        ParseResult result;
+        while (!closing && (result = parseClientFrame(input, consumed, frame, errorCode)) != ParseResult::NeedMore) {
+            if (result == ParseResult::Error) {
+                beginClose(subscriber, errorCode, sentOffset > 0);
+                closing = true;
+                break;
+            }
+            consumed += frame.length;
+            if (frame.opcode == opPing) {
+                auto pong = std::make_shared<const std::string>(encodeWebSocketFrame(opPong, frame.payload));
+                enqueue(subscriber, pong);
+            } else if (frame.opcode == opClose) {
+                uint16_t code = closeNormal;
+                if (frame.payload.size() >= 2) {
+                    code = static_cast<uint16_t>((static_cast<unsigned char>(frame.payload[0]) << 8) |
+                                                 static_cast<unsigned char>(frame.payload[1]));
+                }
+                beginClose(subscriber, code, sentOffset > 0);
+                closing = true;
+            }
+            // Text, binary and continuation frames are accepted and ignored:
+            // the endpoint only pushes. Their size is still capped above.
+        }
+        input.erase(0, consumed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(hubMutex);
+        for (size_t i = 0; i < subscribers.size(); i++) {
+            if (subscribers[i] == &subscriber) {
+                subscribers[i] = subscribers.back();
+                subscribers.pop_back();
+                break;
+            }
+        }
+    }
+    close(subscriber.wakeFd);
+}
+
+void upgrade(RouteContext& context) {
+    HttpRequest& request = context.request;
+    HttpResponse& response = context.response;
+    std::string_view key = findHeader(request, "Sec-WebSocket-Key");
+    if (context.clientSocket < 0 || !containsIgnoreCase(findHeader(request, "Upgrade"), "websocket") ||
+        !containsIgnoreCase(findHeader(request, "Connection"), "upgrade") || key.size() != 24) {
+        setStatus(response, 400, "Bad Request", nullptr);
+        return;
+    }
+    if (findHeader(request, "Sec-WebSocket-Version") != "13") {
+        setStatus(response, 426, "Upgrade Required", nullptr);
+        response.headers.insert(response.headers.size() - 2, "Sec-WebSocket-Version: 13\r\n");
+        return;
+    }
+    response.status = 101;
+    response.headers = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ";
+    response.headers += webSocketAccept(key);
+    response.headers += "\r\n\r\n";
+    response.takeover = runSession;
+}
+
+bool isLoopbackPeer(int clientSocket) {
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    return clientSocket >= 0 && getpeername(clientSocket, reinterpret_cast<sockaddr*>(&address), &length) == 0 &&
+           address.sin_family == AF_INET && (ntohl(address.sin_addr.s_addr) >> 24) == 127;
+}
+
+// POST body is broadcast as one text frame. Reads the part of the body that
+// did not arrive with the headers from the socket.
+void publish(RouteContext& context) {
+    HttpRequest& request = context.request;
+    HttpResponse& response = context.response;
+    if (!isLoopbackPeer(context.clientSocket)) {
+        setStatus(response, 403, "Forbidden", nullptr);
+        return;
+    }
+    size_t headerEnd = request.raw.find("\r\n\r\n");
+    if (headerEnd == std::string_view::npos) {
+        setStatus(response, 431, "Request Header Fields Too Large", nullptr);
+        return;
+    }
+    unsigned long long contentLength = std::strtoull(std::string(findHeader(request, "Content-Length")).c_str(), nullptr, 10);
+    if (contentLength > activeConfig.maxQueueBytes) {
+        setStatus(response, 413, "Payload Too Large", nullptr);
+        return;
+    }
+    std::pmr::string body(request.raw.substr(headerEnd + 4, static_cast<size_t>(contentLength)), &context.arena);
+    char buffer[4096];
+    while (body.size() < contentLength) {
+        ssize_t received = recv(context.clientSocket, buffer, std::min<size_t>(sizeof(buffer), contentLength - body.size()), 0);
+        if (received <= 0) {
+            setStatus(response, 400, "Bad Request", nullptr);
+            return;
+        }
+        body.append(buffer, static_cast<size_t>(received));
+    }
+    size_t delivered = broadcastWebSocket(body);
+    setStatus(response, 200, "OK", "application/json");
+    JsonWriter json(response.body);
+    json.beginObject();
+    json.key("delivered");
+    json.number(delivered);
+    json.endObject();
+}
+
+} // namespace
+
+WebSocketConfig webSocketConfigFromMap(const std::map<std::string, std::string>& config) {
+    WebSocketConfig websocket;
+    websocket.path = getConfigValue(config, "websocket_path", "");
+    if (!websocket.path.empty() && websocket.path[0] != '/') {
+        std::cerr << "Error: websocket_path must start with '/': " << websocket.path << std::endl;
+        websocket.path.clear();
+    }
+    websocket.publishPath = websocket.path + "/publish";
+    websocket.maxQueueBytes = static_cast<size_t>(getConfigNumber(config, "websocket_max_queue_bytes", static_cast<long long>(websocket.maxQueueBytes)));
+    websocket.maxFrameBytes = static_cast<size_t>(getConfigNumber(config, "websocket_max_frame_bytes", static_cast<long long>(websocket.maxFrameBytes)));
+    return websocket;
+}
+
+void sha1(const void* data, size_t size, unsigned char digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    const auto* input = static_cast<const unsigned char*>(data);
+    uint64_t bitLength = static_cast<uint64_t>(size) * 8;
+    size_t paddedSize = ((size + 8) / 64 + 1) * 64;
+    unsigned char block[64];
+    for (size_t offset = 0; offset < paddedSize; offset += 64) {
+        for (size_t i = 0; i < 64; i++) {
+            size_t position = offset + i;
+            if (position < size) {
+                block[i] = input[position];
+            } else if (position == size) {
+                block[i] = 0x80;
+            } else if (position >= paddedSize - 8) {
+                block[i] = static_cast<unsigned char>(bitLength >> (8 * (paddedSize - 1 - position)));
+            } else {
+                block[i] = 0;
+            }
+        }
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) | (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+                   (static_cast<uint32_t>(block[i * 4 + 2]) << 8) | block[i * 4 + 3];
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t next = rotateLeft(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotateLeft(b, 30);
+            b = a;
+            a = next;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 5; i++) {
+        digest[i * 4] = static_cast<unsigned char>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<unsigned char>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<unsigned char>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<unsigned char>(h[i]);
+    }
+}
+
+std::string base64Encode(const unsigned char* data, size_t size) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    encoded.reserve((size + 2) / 3 * 4);
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t group = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < size) {
+            group |= static_cast<uint32_t>(data[i + 1]) << 8;
+        }
+        if (i + 2 < size) {
+            group |= data[i + 2];
+        }
+        encoded += alphabet[(group >> 18) & 0x3f];
+        encoded += alphabet[(group >> 12) & 0x3f];
+        encoded += i + 1 < size ? alphabet[(group >> 6) & 0x3f] : '=';
+        encoded += i + 2 < size ? alphabet[group & 0x3f] : '=';
+    }
+    return encoded;
+}
+
+std::string webSocketAccept(std::string_view key) {
+    std::string input(key);
+    input += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    unsigned char digest[20];
+    sha1(input.data(), input.size(), digest);
+    return base64Encode(digest, sizeof(digest));
+}
+
+std::string encodeWebSocketFrame(uint8_t opcode, std::string_view payload) {
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    frame += static_cast<char>(0x80 | opcode);
+    if (payload.size() < 126) {
+        frame += static_cast<char>(payload.size());
+    } else if (payload.size() <= 0xffff) {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>(payload.size() >> 8);
+        frame += static_cast<char>(payload.size() & 0xff);
+    } else {
+        frame += static_cast<char>(127);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            frame += static_cast<char>((static_cast<uint64_t>(payload.size()) >> shift) & 0xff);
+        }
+    }
+    frame += payload;
+    return frame;
+}
+
+size_t broadcastWebSocket(std::string_view text) {
+    auto frame = std::make_shared<const std::string>(encodeWebSocketFrame(opText, text));
+    broadcastCount++;
+    size_t delivered = 0;
+    std::lock_guard<std::mutex> lock(hubMutex);
+    for (Subscriber* subscriber : subscribers) {
+        if (enqueue(*subscriber, frame)) {
+            delivered++;
+        }
+    }
+    framesQueued += delivered;
+    return delivered;
+}
+
+WebSocketStats webSocketStats() {
+    WebSocketStats stats;
+    {
+        std::lock_guard<std::mutex> lock(hubMutex);
+        stats.subscribers = subscribers.size();
+    }
+    stats.broadcasts = broadcastCount.load();
+    stats.framesQueued = framesQueued.load();
+    stats.slowClientsClosed = slowClientsClosed.load();
+    return stats;
+}
+
+void registerWebSocketRoutes(Router& router, const WebSocketConfig& config) {
+    activeConfig = config;
+    if (config.path.empty()) {
+        return;
+    }
+    router.addExact("GET", config.path, upgrade);
+    router.addExact("POST", config.publishPath, publish);
+}
@@ -0,0 +1,50 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include "router.h"
+
+// RFC 6455 WebSocket endpoint for server-pushed updates. After the upgrade
+// the connection thread runs the session (outside admission control) and
+// multiplexes the socket with an eventfd through poll(). A broadcast is
+// framed once into a shared buffer; every subscriber queues a reference to
+// it and sends from it directly. A subscriber whose unsent bytes exceed
+// maxQueueBytes is closed with 1008 instead of holding memory for it.
+// Subscribers are per process, so the endpoint is only available with
+// workers=0; the server refuses to start otherwise.
+struct WebSocketConfig {
+    std::string path;                  // e.g. "/ws"; empty disables the endpoint
+    std::string publishPath;           // POST from loopback clients; path + "/publish"
+    size_t maxQueueBytes = 1024 * 1024;
+    size_t maxFrameBytes = 64 * 1024;  // largest client frame accepted
+};
+
+struct WebSocketStats {
+    uint64_t subscribers = 0;
+    uint64_t broadcasts = 0;
+    uint64_t framesQueued = 0;
+    uint64_t slowClientsClosed = 0;
+};
+
+WebSocketConfig webSocketConfigFromMap(const std::map<std::string, std::string>& config);
+
+// In-tree helpers for the handshake (no crypto library needed).
+void sha1(const void* data, size_t size, unsigned char digest[20]);
+std::string base64Encode(const unsigned char* data, size_t size);
+std::string webSocketAccept(std::string_view key);
+
+// Builds an unmasked server frame (FIN set).
+std::string encodeWebSocketFrame(uint8_t opcode, std::string_view payload);
+
+// Frames text once and queues it for every subscriber; returns how many got it.
+size_t broadcastWebSocket(std::string_view text);
+WebSocketStats webSocketStats();
+
+// Registers the upgrade route and the publish route when config.path is set.
+void registerWebSocketRoutes(Router& router, const WebSocketConfig& config);
+
+#endif // WEBSOCKET_H